@@ -1918,6 +1918,31 @@ static BOOL d2d_geometry_apply_intersections(struct d2d_geometry *geometry,
     return TRUE;
 }
 
+/* Bounds of the segment's control polygon; these contain the segment itself. */
+static void d2d_figure_get_segment_hull(const struct d2d_figure *figure,
+        const struct d2d_segment_idx *idx, enum d2d_vertex_type type, D2D_RECT_F *hull)
+{
+    size_t next;
+
+    hull->left = hull->right = figure->vertices[idx->vertex_idx].x;
+    hull->top = hull->bottom = figure->vertices[idx->vertex_idx].y;
+
+    next = idx->vertex_idx + 1;
+    if (next == figure->vertex_count)
+        next = 0;
+    d2d_rect_expand(hull, &figure->vertices[next]);
+
+    if (type == D2D_VERTEX_TYPE_BEZIER)
+        d2d_rect_expand(hull, &figure->bezier_controls[idx->control_idx]);
+}
+
+/* Like d2d_rect_check_overlap(), but rectangles that only share an edge or a
+ * corner also count, since their segments can still intersect there. */
+static BOOL d2d_rect_check_touch(const D2D_RECT_F *p, const D2D_RECT_F *q)
+{
+    return p->left <= q->right && p->top <= q->bottom && p->right >= q->left && p->bottom >= q->top;
+}
+
 /* Intersect the geometry's segments with themselves. This uses the
  * straightforward approach of testing everything against everything, but
  * there certainly exist more scalable algorithms for this. */
@@ -1927,6 +1952,7 @@ static BOOL d2d_geometry_intersect_self(struct d2d_geometry *geometry)
     const struct d2d_figure *figure_p, *figure_q;
     struct d2d_segment_idx idx_p, idx_q;
     enum d2d_vertex_type type_p, type_q;
+    D2D_RECT_F hull_p, hull_q;
     BOOL ret = FALSE;
     size_t max_q;
 
@@ -1940,6 +1966,7 @@ static BOOL d2d_geometry_intersect_self(struct d2d_geometry *geometry)
         for (idx_p.vertex_idx = 0; idx_p.vertex_idx < figure_p->vertex_count; ++idx_p.vertex_idx)
         {
             type_p = figure_p->vertex_types[idx_p.vertex_idx];
+            d2d_figure_get_segment_hull(figure_p, &idx_p, type_p, &hull_p);
             for (idx_q.figure_idx = 0; idx_q.figure_idx <= idx_p.figure_idx; ++idx_q.figure_idx)
             {
                 figure_q = &geometry->u.path.figures[idx_q.figure_idx];
@@ -1958,6 +1985,15 @@ static BOOL d2d_geometry_intersect_self(struct d2d_geometry *geometry)
                 for (idx_q.vertex_idx = 0; idx_q.vertex_idx < max_q; ++idx_q.vertex_idx)
                 {
                     type_q = figure_q->vertex_types[idx_q.vertex_idx];
+                    /* Segments can't intersect if their control polygons don't. */
+                    d2d_figure_get_segment_hull(figure_q, &idx_q, type_q, &hull_q);
+                    if (!d2d_rect_check_touch(&hull_p, &hull_q))
+                    {
+                        if (type_q == D2D_VERTEX_TYPE_BEZIER)
+                            ++idx_q.control_idx;
+                        continue;
+                    }
+
                     if (type_q == D2D_VERTEX_TYPE_BEZIER)
                     {
                         if (type_p == D2D_VERTEX_TYPE_BEZIER)
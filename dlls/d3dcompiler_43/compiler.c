@@ -751,8 +751,108 @@ static const struct target_info * get_target_info(const char *target)
     return NULL;
 }
 
+/* Applications often compile the same shaders over and over, keep the
+ * bytecode of the last successful compilations around. The compiled shader
+ * only depends on the preprocessed source, the target, the entry point and
+ * the compile flags, so those are used as the key. Protected by wpp_mutex. */
+#define SHADER_CACHE_SIZE 64
+
+struct cached_shader
+{
+    struct list entry;
+    DWORD hash;
+    char *source;
+    char *target;
+    char *entrypoint;
+    UINT sflags;
+    DWORD *bytecode;
+    DWORD size;
+};
+
+static struct list shader_cache = LIST_INIT(shader_cache);
+static unsigned int shader_cache_count;
+static unsigned int shader_cache_hits, shader_cache_misses;
+
+static DWORD hash_shader_source(const char *source)
+{
+    DWORD hash = 2166136261u;
+
+    while (*source)
+    {
+        hash ^= (unsigned char)*source++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static struct cached_shader *find_cached_shader(DWORD hash, const char *source,
+        const char *target, const char *entrypoint, UINT sflags)
+{
+    struct cached_shader *cached;
+
+    LIST_FOR_EACH_ENTRY(cached, &shader_cache, struct cached_shader, entry)
+    {
+        if (cached->hash == hash && cached->sflags == sflags && !strcmp(cached->target, target)
+                && !strcmp(cached->entrypoint, entrypoint) && !strcmp(cached->source, source))
+        {
+            list_remove(&cached->entry);
+            list_add_head(&shader_cache, &cached->entry);
+            TRACE("Shader cache hit, %u hits, %u misses.\n", ++shader_cache_hits, shader_cache_misses);
+            return cached;
+        }
+    }
+
+    TRACE("Shader cache miss, %u hits, %u misses.\n", shader_cache_hits, ++shader_cache_misses);
+    return NULL;
+}
+
+static void free_cached_shader(struct cached_shader *cached)
+{
+    d3dcompiler_free(cached->source);
+    d3dcompiler_free(cached->target);
+    d3dcompiler_free(cached->entrypoint);
+    d3dcompiler_free(cached->bytecode);
+    d3dcompiler_free(cached);
+}
+
+static void cache_shader(DWORD hash, const char *source, const char *target,
+        const char *entrypoint, UINT sflags, const DWORD *bytecode, DWORD size)
+{
+    struct cached_shader *cached;
+
+    if (!(cached = d3dcompiler_alloc(sizeof(*cached))))
+        return;
+
+    cached->hash = hash;
+    cached->source = d3dcompiler_strdup(source);
+    cached->target = d3dcompiler_strdup(target);
+    cached->entrypoint = d3dcompiler_strdup(entrypoint);
+    cached->sflags = sflags;
+    cached->bytecode = d3dcompiler_alloc(size);
+    cached->size = size;
+    if (!cached->source || !cached->target || !cached->entrypoint || !cached->bytecode)
+    {
+        free_cached_shader(cached);
+        return;
+    }
+    memcpy(cached->bytecode, bytecode, size);
+
+    if (shader_cache_count == SHADER_CACHE_SIZE)
+    {
+        struct cached_shader *oldest = LIST_ENTRY(list_tail(&shader_cache), struct cached_shader, entry);
+
+        list_remove(&oldest->entry);
+        free_cached_shader(oldest);
+    }
+    else
+    {
+        ++shader_cache_count;
+    }
+    list_add_head(&shader_cache, &cached->entry);
+}
+
 static HRESULT compile_shader(const char *preproc_shader, const char *target, const char *entrypoint,
-        ID3DBlob **shader_blob, ID3DBlob **error_messages)
+        UINT sflags, ID3DBlob **shader_blob, ID3DBlob **error_messages)
 {
     struct bwriter_shader *shader;
     char *messages = NULL;
@@ -762,6 +862,9 @@ static HRESULT compile_shader(const char *preproc_shader, const char *target, co
     char *pos;
     enum shader_type shader_type;
     const struct target_info *info;
+    struct cached_shader *cached;
+    BOOL has_messages;
+    DWORD hash = 0;
 
     TRACE("Preprocessed shader source: %s\n", debugstr_a(preproc_shader));
 
@@ -787,8 +890,25 @@ static HRESULT compile_shader(const char *preproc_shader, const char *target, co
         }
     }
 
+    if (entrypoint)
+    {
+        hash = hash_shader_source(preproc_shader);
+        if ((cached = find_cached_shader(hash, preproc_shader, target, entrypoint, sflags)))
+        {
+            if (shader_blob)
+            {
+                if (FAILED(hr = D3DCreateBlob(cached->size, &buffer)))
+                    return hr;
+                memcpy(ID3D10Blob_GetBufferPointer(buffer), cached->bytecode, cached->size);
+                *shader_blob = buffer;
+            }
+            return S_OK;
+        }
+    }
+
     shader = parse_hlsl_shader(preproc_shader, shader_type, major, minor, entrypoint, &messages);
 
+    has_messages = !!messages;
     if (messages)
     {
         TRACE("Compiler messages:\n");
@@ -837,6 +957,10 @@ static HRESULT compile_shader(const char *preproc_shader, const char *target, co
         return D3DXERR_INVALIDDATA;
     }
 
+    /* Don't cache shaders producing warnings, those need to be reported again. */
+    if (entrypoint && !has_messages)
+        cache_shader(hash, preproc_shader, target, entrypoint, sflags, res, size);
+
     if (shader_blob)
     {
         hr = D3DCreateBlob(size, &buffer);
@@ -879,7 +1003,7 @@ HRESULT WINAPI D3DCompile2(const void *data, SIZE_T data_size, const char *filen
 
     hr = preprocess_shader(data, data_size, filename, defines, include, error_messages);
     if (SUCCEEDED(hr))
-        hr = compile_shader(wpp_output, target, entrypoint, shader, error_messages);
+        hr = compile_shader(wpp_output, target, entrypoint, sflags, shader, error_messages);
 
     HeapFree(GetProcessHeap(), 0, wpp_output);
     LeaveCriticalSection(&wpp_mutex);
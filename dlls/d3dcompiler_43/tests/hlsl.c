@@ -626,6 +626,61 @@ static void test_fail(IDirect3DDevice9 *device, IDirect3DVertexBuffer9 *qquad_ge
     }
 }
 
+static void test_repeated_compile(void)
+{
+    static const char shader[] =
+        "float4 test(float2 pos: TEXCOORD0) : COLOR\n"
+        "{\n"
+        "    return float4(pos.x, pos.y, 0.0, 1.0);\n"
+        "}\n"
+        "float4 test2(float2 pos: TEXCOORD0) : COLOR\n"
+        "{\n"
+        "    return float4(pos.y, pos.x, 1.0, 0.0);\n"
+        "}";
+    static const struct
+    {
+        const char *entrypoint;
+        const char *target;
+        UINT sflags;
+    }
+    tests[] =
+    {
+        {"test2", "ps_2_0", 0},
+        {"test",  "ps_3_0", 0},
+        {"test",  "ps_2_0", D3DCOMPILE_DEBUG},
+    };
+    ID3D10Blob *first, *compiled;
+    unsigned int i;
+    HRESULT hr;
+
+    hr = ppD3DCompile(shader, strlen(shader), NULL, NULL, NULL, "test", "ps_2_0", 0, 0, &first, NULL);
+    todo_wine ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    if (FAILED(hr))
+        return;
+
+    /* Compiling the same shader again gives the same bytecode. */
+    hr = ppD3DCompile(shader, strlen(shader), NULL, NULL, NULL, "test", "ps_2_0", 0, 0, &compiled, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    ok(ID3D10Blob_GetBufferSize(compiled) == ID3D10Blob_GetBufferSize(first)
+            && !memcmp(ID3D10Blob_GetBufferPointer(compiled), ID3D10Blob_GetBufferPointer(first),
+            ID3D10Blob_GetBufferSize(first)), "Got different bytecode.\n");
+    ID3D10Blob_Release(compiled);
+
+    /* Changing any one of the entry point, target or flags gives a different shader. */
+    for (i = 0; i < ARRAY_SIZE(tests); ++i)
+    {
+        hr = ppD3DCompile(shader, strlen(shader), NULL, NULL, NULL, tests[i].entrypoint,
+                tests[i].target, tests[i].sflags, 0, &compiled, NULL);
+        ok(hr == S_OK, "Test %u, got unexpected hr %#x.\n", i, hr);
+        ok(ID3D10Blob_GetBufferSize(compiled) != ID3D10Blob_GetBufferSize(first)
+                || memcmp(ID3D10Blob_GetBufferPointer(compiled), ID3D10Blob_GetBufferPointer(first),
+                ID3D10Blob_GetBufferSize(first)), "Test %u, got the same bytecode.\n", i);
+        ID3D10Blob_Release(compiled);
+    }
+
+    ID3D10Blob_Release(first);
+}
+
 static BOOL load_d3dcompiler(void)
 {
     HMODULE module;
@@ -656,6 +711,8 @@ START_TEST(hlsl)
         return;
     }
 
+    test_repeated_compile();
+
     if (!(mod = LoadLibraryA("d3dx9_36.dll")))
     {
         win_skip("Failed to load d3dx9_36.dll.\n");
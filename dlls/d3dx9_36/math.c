@@ -1673,88 +1673,105 @@ D3DXVECTOR2* WINAPI D3DXVec2Normalize(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv)
     return pout;
 }
 
-D3DXVECTOR4* WINAPI D3DXVec2Transform(D3DXVECTOR4 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+static inline void vec2_transform(D3DXVECTOR4 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR4 out;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
-
     out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y  + pm->u.m[3][0];
     out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y  + pm->u.m[3][1];
     out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y  + pm->u.m[3][2];
     out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y  + pm->u.m[3][3];
     *pout = out;
+}
+
+D3DXVECTOR4* WINAPI D3DXVec2Transform(D3DXVECTOR4 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
+
+    vec2_transform(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec2TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec2Transform(
+        vec2_transform(
             (D3DXVECTOR4*)((char*)out + outstride * i),
             (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
 
-D3DXVECTOR2* WINAPI D3DXVec2TransformCoord(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+static inline void vec2_transform_coord(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR2 v;
     FLOAT norm;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
-
     v = *pv;
     norm = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[3][3];
 
     pout->x = (pm->u.m[0][0] * v.x + pm->u.m[1][0] * v.y + pm->u.m[3][0]) / norm;
     pout->y = (pm->u.m[0][1] * v.x + pm->u.m[1][1] * v.y + pm->u.m[3][1]) / norm;
+}
+
+D3DXVECTOR2* WINAPI D3DXVec2TransformCoord(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
+    vec2_transform_coord(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR2* WINAPI D3DXVec2TransformCoordArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformCoord(
+        vec2_transform_coord(
             (D3DXVECTOR2*)((char*)out + outstride * i),
             (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
 
-D3DXVECTOR2* WINAPI D3DXVec2TransformNormal(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+static inline void vec2_transform_normal(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
 {
     const D3DXVECTOR2 v = *pv;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
-
     pout->x = pm->u.m[0][0] * v.x + pm->u.m[1][0] * v.y;
     pout->y = pm->u.m[0][1] * v.x + pm->u.m[1][1] * v.y;
+}
+
+D3DXVECTOR2* WINAPI D3DXVec2TransformNormal(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
+
+    vec2_transform_normal(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR2* WINAPI D3DXVec2TransformNormalArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2 *in, UINT instride, const D3DXMATRIX *matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformNormal(
+        vec2_transform_normal(
             (D3DXVECTOR2*)((char*)out + outstride * i),
             (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
@@ -1859,42 +1876,46 @@ D3DXVECTOR3* WINAPI D3DXVec3ProjectArray(D3DXVECTOR3* out, UINT outstride, const
     return out;
 }
 
-D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+static inline void vec3_transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR4 out;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
-
     out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0];
     out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1];
     out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2];
     out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] * pv->z + pm->u.m[3][3];
     *pout = out;
+}
+
+D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
+
+    vec3_transform(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec3TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec3Transform(
+        vec3_transform(
             (D3DXVECTOR4*)((char*)out + outstride * i),
             (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
 
-D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+static inline void vec3_transform_coord(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR3 out;
     FLOAT norm;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
-
     norm = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] *pv->z + pm->u.m[3][3];
 
     out.x = (pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0]) / norm;
@@ -1902,49 +1923,61 @@ D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3
     out.z = (pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2]) / norm;
 
     *pout = out;
+}
 
+D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
+
+    vec3_transform_coord(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformCoordArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformCoord(
+        vec3_transform_coord(
             (D3DXVECTOR3*)((char*)out + outstride * i),
             (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
 
-D3DXVECTOR3* WINAPI D3DXVec3TransformNormal(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+static inline void vec3_transform_normal(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
 {
     const D3DXVECTOR3 v = *pv;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
-
     pout->x = pm->u.m[0][0] * v.x + pm->u.m[1][0] * v.y + pm->u.m[2][0] * v.z;
     pout->y = pm->u.m[0][1] * v.x + pm->u.m[1][1] * v.y + pm->u.m[2][1] * v.z;
     pout->z = pm->u.m[0][2] * v.x + pm->u.m[1][2] * v.y + pm->u.m[2][2] * v.z;
-    return pout;
+}
+
+D3DXVECTOR3* WINAPI D3DXVec3TransformNormal(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
+    vec3_transform_normal(pout, pv, pm);
+    return pout;
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformNormalArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformNormal(
+        vec3_transform_normal(
             (D3DXVECTOR3*)((char*)out + outstride * i),
             (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
@@ -2066,31 +2099,37 @@ D3DXVECTOR4* WINAPI D3DXVec4Normalize(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv)
     return pout;
 }
 
-D3DXVECTOR4* WINAPI D3DXVec4Transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv, const D3DXMATRIX *pm)
+static inline void vec4_transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv, const D3DXMATRIX *pm)
 {
     D3DXVECTOR4 out;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
-
     out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0] * pv->w;
     out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1] * pv->w;
     out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2] * pv->w;
     out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] * pv->z + pm->u.m[3][3] * pv->w;
     *pout = out;
+}
+
+D3DXVECTOR4* WINAPI D3DXVec4Transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
+
+    vec4_transform(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec4TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR4* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
     for (i = 0; i < elements; ++i) {
-        D3DXVec4Transform(
+        vec4_transform(
             (D3DXVECTOR4*)((char*)out + outstride * i),
             (const D3DXVECTOR4*)((const char*)in + instride * i),
-            matrix);
+            &m);
     }
     return out;
 }
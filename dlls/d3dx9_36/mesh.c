@@ -1229,6 +1229,9 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
     /* shared_indices links together identical indices in the index buffer so
      * that adjacency checks can be limited to faces sharing a vertex */
     DWORD *shared_indices = NULL;
+    /* sorted indices of the vertices coincident with the current vertex */
+    DWORD *coincident_vertices;
+    DWORD coincident_count;
     const FLOAT epsilon_sq = epsilon * epsilon;
     DWORD i;
 
@@ -1237,13 +1240,15 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
     if (!adjacency)
         return D3DERR_INVALIDCALL;
 
-    buffer_size = This->numfaces * 3 * sizeof(*shared_indices) + This->numvertices * sizeof(*sorted_vertices);
+    buffer_size = This->numfaces * 3 * sizeof(*shared_indices) + This->numvertices * sizeof(*sorted_vertices)
+            + This->numvertices * sizeof(*coincident_vertices);
     if (!(This->options & D3DXMESH_32BIT))
         buffer_size += This->numfaces * 3 * sizeof(*indices);
     shared_indices = HeapAlloc(GetProcessHeap(), 0, buffer_size);
     if (!shared_indices)
         return E_OUTOFMEMORY;
     sorted_vertices = (struct vertex_metadata*)(shared_indices + This->numfaces * 3);
+    coincident_vertices = (DWORD *)(sorted_vertices + This->numvertices);
 
     hr = iface->lpVtbl->LockVertexBuffer(iface, D3DLOCK_READONLY, (void**)&vertices);
     if (FAILED(hr)) goto cleanup;
@@ -1252,7 +1257,7 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
 
     if (!(This->options & D3DXMESH_32BIT)) {
         const WORD *word_indices = (const WORD*)indices;
-        DWORD *dword_indices = (DWORD*)(sorted_vertices + This->numvertices);
+        DWORD *dword_indices = coincident_vertices + This->numvertices;
         indices = dword_indices;
         for (i = 0; i < This->numfaces * 3; i++)
             *dword_indices++ = *word_indices++;
@@ -1277,12 +1282,34 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
         struct vertex_metadata *sorted_vertex_a = &sorted_vertices[i];
         D3DXVECTOR3 *vertex_a = (D3DXVECTOR3*)(vertices + sorted_vertex_a->vertex_index * vertex_size);
         DWORD shared_index_a = sorted_vertex_a->first_shared_index;
+        DWORD j;
+
+        if (shared_index_a == -1)
+            continue;
+
+        /* The coincident vertices are the same for every face sharing this
+         * vertex, only look for them once. */
+        coincident_count = 0;
+        for (j = i + 1; j < This->numvertices; j++) {
+            struct vertex_metadata *sorted_vertex_b = &sorted_vertices[j];
+            D3DXVECTOR3 *vertex_b;
+
+            if (sorted_vertex_b->key - sorted_vertex_a->key > epsilon * 3.0f)
+                break;
+            /* check for coincidence */
+            vertex_b = (D3DXVECTOR3*)(vertices + sorted_vertex_b->vertex_index * vertex_size);
+            if (fabsf(vertex_a->x - vertex_b->x) <= epsilon &&
+                fabsf(vertex_a->y - vertex_b->y) <= epsilon &&
+                fabsf(vertex_a->z - vertex_b->z) <= epsilon)
+            {
+                coincident_vertices[coincident_count++] = j;
+            }
+        }
 
         while (shared_index_a != -1) {
-            DWORD j = i;
             DWORD shared_index_b = shared_indices[shared_index_a];
-            struct vertex_metadata *sorted_vertex_b = sorted_vertex_a;
 
+            j = 0;
             while (TRUE) {
                 while (shared_index_b != -1) {
                     /* faces are adjacent if they have another coincident vertex */
@@ -1326,27 +1353,10 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
 
                     shared_index_b = shared_indices[shared_index_b];
                 }
-                while (++j < This->numvertices) {
-                    D3DXVECTOR3 *vertex_b;
-
-                    sorted_vertex_b++;
-                    if (sorted_vertex_b->key - sorted_vertex_a->key > epsilon * 3.0f) {
-                        /* no more coincident vertices to try */
-                        j = This->numvertices;
-                        break;
-                    }
-                    /* check for coincidence */
-                    vertex_b = (D3DXVECTOR3*)(vertices + sorted_vertex_b->vertex_index * vertex_size);
-                    if (fabsf(vertex_a->x - vertex_b->x) <= epsilon &&
-                        fabsf(vertex_a->y - vertex_b->y) <= epsilon &&
-                        fabsf(vertex_a->z - vertex_b->z) <= epsilon)
-                    {
-                        break;
-                    }
-                }
-                if (j >= This->numvertices)
+                /* no more coincident vertices to try */
+                if (j >= coincident_count)
                     break;
-                shared_index_b = sorted_vertex_b->first_shared_index;
+                shared_index_b = sorted_vertices[coincident_vertices[j++]].first_shared_index;
             }
 
             sorted_vertex_a->first_shared_index = shared_indices[sorted_vertex_a->first_shared_index];
@@ -1603,10 +1603,11 @@ static double exec_get_arg(struct d3dx_regstore *rs, const struct d3dx_pres_oper
 
     table = opr->reg.table;
 
+    /* Registers of non relative operands are validated in parse_preshader(). */
     if (opr->index_reg.table == PRES_REGTAB_COUNT)
-        base_index = 0;
-    else
-        base_index = lrint(exec_get_reg_value(rs, opr->index_reg.table, opr->index_reg.offset));
+        return exec_get_reg_value(rs, table, opr->reg.offset + comp);
+
+    base_index = lrint(exec_get_reg_value(rs, opr->index_reg.table, opr->index_reg.offset));
 
     offset = get_offset_reg(table, base_index) + opr->reg.offset + comp;
     reg_index = get_reg_offset(table, offset);
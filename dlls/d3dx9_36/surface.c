@@ -1810,6 +1810,98 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     }
 }
 
+/* Number of pixel rows compressed at a time, must be a multiple of the block height. */
+#define DXTN_BAND_HEIGHT 64
+
+struct dxtn_compress_ctx
+{
+    const BYTE *src;
+    BYTE *dst;
+    unsigned int width, height;
+    GLenum format;
+    int dst_stride;
+    unsigned int dst_band_size;
+    unsigned int band_count;
+    LONG next_band;
+    LONG pending_workers;
+    HANDLE done_event;
+};
+
+static void dxtn_compress_bands(struct dxtn_compress_ctx *ctx)
+{
+    unsigned int band, y;
+
+    while ((band = InterlockedIncrement(&ctx->next_band) - 1) < ctx->band_count)
+    {
+        y = band * DXTN_BAND_HEIGHT;
+        tx_compress_dxtn(4, ctx->width, min(ctx->height - y, DXTN_BAND_HEIGHT),
+                ctx->src + y * ctx->width * sizeof(DWORD), ctx->format,
+                ctx->dst + band * ctx->dst_band_size, ctx->dst_stride);
+    }
+}
+
+static void CALLBACK dxtn_compress_worker(TP_CALLBACK_INSTANCE *instance, void *context)
+{
+    struct dxtn_compress_ctx *ctx = context;
+
+    dxtn_compress_bands(ctx);
+    if (!InterlockedDecrement(&ctx->pending_workers))
+        SetEvent(ctx->done_event);
+}
+
+/* Blocks are compressed independently of each other, so large surfaces are
+ * split in bands of block rows compressed in parallel. */
+static void compress_dxtn(const BYTE *src, unsigned int width, unsigned int height,
+        GLenum format, BYTE *dst, int dst_stride)
+{
+    struct dxtn_compress_ctx ctx;
+    unsigned int block_size, row_size, worker_count, i;
+    SYSTEM_INFO info;
+
+    ctx.src = src;
+    ctx.dst = dst;
+    ctx.width = width;
+    ctx.height = height;
+    ctx.format = format;
+    ctx.dst_stride = dst_stride;
+    ctx.band_count = (height + DXTN_BAND_HEIGHT - 1) / DXTN_BAND_HEIGHT;
+    ctx.next_band = 0;
+    ctx.pending_workers = 0;
+    ctx.done_event = NULL;
+
+    /* This matches the destination row advance in tx_compress_dxtn(). */
+    block_size = format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? 2 : 4;
+    row_size = max(dst_stride, ((width + 3) & ~3) * block_size);
+    ctx.dst_band_size = row_size * (DXTN_BAND_HEIGHT / 4);
+
+    GetSystemInfo(&info);
+    worker_count = min(info.dwNumberOfProcessors, ctx.band_count) - 1;
+    if (worker_count && (ctx.done_event = CreateEventW(NULL, TRUE, FALSE, NULL)))
+    {
+        ctx.pending_workers = worker_count;
+        for (i = 0; i < worker_count; ++i)
+        {
+            if (!TrySubmitThreadpoolCallback(dxtn_compress_worker, &ctx, NULL))
+            {
+                LONG skipped = worker_count - i;
+
+                WARN("Failed to submit compression worker.\n");
+                if (InterlockedExchangeAdd(&ctx.pending_workers, -skipped) == skipped)
+                    SetEvent(ctx.done_event);
+                break;
+            }
+        }
+    }
+
+    dxtn_compress_bands(&ctx);
+
+    if (ctx.done_event)
+    {
+        WaitForSingleObject(ctx.done_event, INFINITE);
+        CloseHandle(ctx.done_event);
+    }
+}
+
 /************************************************************
  * D3DXLoadSurfaceFromMemory
  *
@@ -2080,8 +2172,8 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
                 default:
                     ERR("Unexpected destination compressed format %u.\n", surfdesc.Format);
             }
-            tx_compress_dxtn(4, dst_size_aligned.width, dst_size_aligned.height,
-                    dst_uncompressed, gl_format, lockrect.pBits,
+            compress_dxtn(dst_uncompressed, dst_size_aligned.width, dst_size_aligned.height,
+                    gl_format, lockrect.pBits,
                     lockrect.Pitch * destformatdesc->block_width / destformatdesc->block_byte_count);
             heap_free(dst_uncompressed);
         }
@@ -3200,6 +3200,130 @@ static void test_D3DXVec_Array(void)
     }
 }
 
+static void check_stride_gap(const float *out, unsigned int count, unsigned int stride,
+        unsigned int size, const char *func)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < count; ++i)
+    {
+        for (j = size; j < stride; ++j)
+        {
+            ok(out[i * stride + j] == -1.0f, "%s: got unexpected value %.8e at index %u, offset %u.\n",
+                    func, out[i * stride + j], i, j);
+        }
+    }
+}
+
+/* Compare the array functions with the single vector ones, on input and output
+ * strides which aren't a multiple of the vector size. */
+static void test_D3DXVec_Array_stride(void)
+{
+    enum { count = 9, in_stride = 7, out_stride = 6 };
+    float in[count * in_stride], out[count * out_stride];
+    D3DXVECTOR4 exp4, *out4;
+    D3DXVECTOR3 exp3, *out3;
+    D3DXVECTOR2 exp2, *out2;
+    D3DXMATRIX mat;
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(in); ++i)
+        in[i] = (float)((int)(i * 7 % 23) - 11) / 3.0f;
+
+    set_matrix(&mat,
+            0.5f, -1.25f, 3.0f, 0.125f,
+            2.0f, 0.75f, -0.5f, 0.25f,
+            -1.5f, 4.0f, 1.0f, -0.375f,
+            3.25f, -2.0f, 0.5f, 8.0f);
+
+    for (i = 0; i < ARRAY_SIZE(out); ++i) out[i] = -1.0f;
+    D3DXVec2TransformArray((D3DXVECTOR4 *)out, out_stride * sizeof(float),
+            (D3DXVECTOR2 *)in, in_stride * sizeof(float), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec2Transform(&exp4, (D3DXVECTOR2 *)&in[i * in_stride], &mat);
+        out4 = (D3DXVECTOR4 *)&out[i * out_stride];
+        ok(compare_vec4(&exp4, out4, 1), "D3DXVec2TransformArray: got {%.8e, %.8e, %.8e, %.8e} at index %u, "
+                "expected {%.8e, %.8e, %.8e, %.8e}.\n", out4->x, out4->y, out4->z, out4->w, i,
+                exp4.x, exp4.y, exp4.z, exp4.w);
+    }
+    check_stride_gap(out, count, out_stride, 4, "D3DXVec2TransformArray");
+
+    for (i = 0; i < ARRAY_SIZE(out); ++i) out[i] = -1.0f;
+    D3DXVec2TransformCoordArray((D3DXVECTOR2 *)out, out_stride * sizeof(float),
+            (D3DXVECTOR2 *)in, in_stride * sizeof(float), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec2TransformCoord(&exp2, (D3DXVECTOR2 *)&in[i * in_stride], &mat);
+        out2 = (D3DXVECTOR2 *)&out[i * out_stride];
+        ok(compare_vec2(&exp2, out2, 2), "D3DXVec2TransformCoordArray: got {%.8e, %.8e} at index %u, "
+                "expected {%.8e, %.8e}.\n", out2->x, out2->y, i, exp2.x, exp2.y);
+    }
+    check_stride_gap(out, count, out_stride, 2, "D3DXVec2TransformCoordArray");
+
+    for (i = 0; i < ARRAY_SIZE(out); ++i) out[i] = -1.0f;
+    D3DXVec2TransformNormalArray((D3DXVECTOR2 *)out, out_stride * sizeof(float),
+            (D3DXVECTOR2 *)in, in_stride * sizeof(float), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec2TransformNormal(&exp2, (D3DXVECTOR2 *)&in[i * in_stride], &mat);
+        out2 = (D3DXVECTOR2 *)&out[i * out_stride];
+        ok(compare_vec2(&exp2, out2, 1), "D3DXVec2TransformNormalArray: got {%.8e, %.8e} at index %u, "
+                "expected {%.8e, %.8e}.\n", out2->x, out2->y, i, exp2.x, exp2.y);
+    }
+    check_stride_gap(out, count, out_stride, 2, "D3DXVec2TransformNormalArray");
+
+    for (i = 0; i < ARRAY_SIZE(out); ++i) out[i] = -1.0f;
+    D3DXVec3TransformArray((D3DXVECTOR4 *)out, out_stride * sizeof(float),
+            (D3DXVECTOR3 *)in, in_stride * sizeof(float), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec3Transform(&exp4, (D3DXVECTOR3 *)&in[i * in_stride], &mat);
+        out4 = (D3DXVECTOR4 *)&out[i * out_stride];
+        ok(compare_vec4(&exp4, out4, 1), "D3DXVec3TransformArray: got {%.8e, %.8e, %.8e, %.8e} at index %u, "
+                "expected {%.8e, %.8e, %.8e, %.8e}.\n", out4->x, out4->y, out4->z, out4->w, i,
+                exp4.x, exp4.y, exp4.z, exp4.w);
+    }
+    check_stride_gap(out, count, out_stride, 4, "D3DXVec3TransformArray");
+
+    for (i = 0; i < ARRAY_SIZE(out); ++i) out[i] = -1.0f;
+    D3DXVec3TransformCoordArray((D3DXVECTOR3 *)out, out_stride * sizeof(float),
+            (D3DXVECTOR3 *)in, in_stride * sizeof(float), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec3TransformCoord(&exp3, (D3DXVECTOR3 *)&in[i * in_stride], &mat);
+        out3 = (D3DXVECTOR3 *)&out[i * out_stride];
+        ok(compare_vec3(&exp3, out3, 2), "D3DXVec3TransformCoordArray: got {%.8e, %.8e, %.8e} at index %u, "
+                "expected {%.8e, %.8e, %.8e}.\n", out3->x, out3->y, out3->z, i, exp3.x, exp3.y, exp3.z);
+    }
+    check_stride_gap(out, count, out_stride, 3, "D3DXVec3TransformCoordArray");
+
+    for (i = 0; i < ARRAY_SIZE(out); ++i) out[i] = -1.0f;
+    D3DXVec3TransformNormalArray((D3DXVECTOR3 *)out, out_stride * sizeof(float),
+            (D3DXVECTOR3 *)in, in_stride * sizeof(float), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec3TransformNormal(&exp3, (D3DXVECTOR3 *)&in[i * in_stride], &mat);
+        out3 = (D3DXVECTOR3 *)&out[i * out_stride];
+        ok(compare_vec3(&exp3, out3, 1), "D3DXVec3TransformNormalArray: got {%.8e, %.8e, %.8e} at index %u, "
+                "expected {%.8e, %.8e, %.8e}.\n", out3->x, out3->y, out3->z, i, exp3.x, exp3.y, exp3.z);
+    }
+    check_stride_gap(out, count, out_stride, 3, "D3DXVec3TransformNormalArray");
+
+    for (i = 0; i < ARRAY_SIZE(out); ++i) out[i] = -1.0f;
+    D3DXVec4TransformArray((D3DXVECTOR4 *)out, out_stride * sizeof(float),
+            (D3DXVECTOR4 *)in, in_stride * sizeof(float), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec4Transform(&exp4, (D3DXVECTOR4 *)&in[i * in_stride], &mat);
+        out4 = (D3DXVECTOR4 *)&out[i * out_stride];
+        ok(compare_vec4(&exp4, out4, 1), "D3DXVec4TransformArray: got {%.8e, %.8e, %.8e, %.8e} at index %u, "
+                "expected {%.8e, %.8e, %.8e, %.8e}.\n", out4->x, out4->y, out4->z, out4->w, i,
+                exp4.x, exp4.y, exp4.z, exp4.w);
+    }
+    check_stride_gap(out, count, out_stride, 4, "D3DXVec4TransformArray");
+}
+
 static void test_D3DXFloat_Array(void)
 {
     unsigned int i;
@@ -4379,6 +4503,7 @@ START_TEST(math)
     test_Matrix_Decompose();
     test_Matrix_Transformation2D();
     test_D3DXVec_Array();
+    test_D3DXVec_Array_stride();
     test_D3DXFloat_Array();
     test_D3DXSHAdd();
     test_D3DXSHDot();
@@ -372,6 +372,7 @@ struct module
     unsigned                    num_symbols;
     unsigned                    sorttab_size;
     struct symt_ht**            addr_sorttab;
+    ULONG64*                    sorttab_addr;   /* cached addresses of addr_sorttab[0..num_sorttab) */
     struct hash_table           ht_symbols;
 
     /* types */
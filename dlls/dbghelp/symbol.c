@@ -53,6 +53,13 @@ static inline int cmp_sorttab_addr(struct module* module, int idx, ULONG64 addr)
     return cmp_addr(ref, addr);
 }
 
+/* same as cmp_sorttab_addr, but using the addresses cached by resort_symbols */
+static inline int cmp_sorted_addr(struct module* module, int idx, ULONG64 addr)
+{
+    if (!module->sorttab_addr) return cmp_sorttab_addr(module, idx, addr);
+    return cmp_addr(module->sorttab_addr[idx], addr);
+}
+
 int symt_cmp_addr(const void* p1, const void* p2)
 {
     const struct symt*  sym1 = *(const struct symt* const *)p1;
@@ -789,6 +796,8 @@ static inline unsigned where_to_insert(struct module* module, unsigned high, con
  */
 static BOOL resort_symbols(struct module* module)
 {
+    ULONG64*    new_addr;
+    unsigned    idx;
     int delta;
 
     if (!(module->module.NumSyms = module->num_symbols))
@@ -835,6 +844,19 @@ static BOOL resort_symbols(struct module* module)
         }
     }
     module->num_sorttab = module->num_symbols;
+
+    /* cache the symbols' addresses, so that lookups don't have to compute them */
+    new_addr = module->sorttab_addr
+        ? HeapReAlloc(GetProcessHeap(), 0, module->sorttab_addr, module->num_sorttab * sizeof(ULONG64))
+        : HeapAlloc(GetProcessHeap(), 0, module->num_sorttab * sizeof(ULONG64));
+    if (new_addr)
+    {
+        for (idx = 0; idx < module->num_sorttab; idx++)
+            symt_get_address(&module->addr_sorttab[idx]->symt, &new_addr[idx]);
+    }
+    else HeapFree(GetProcessHeap(), 0, module->sorttab_addr);
+    module->sorttab_addr = new_addr;
+
     return module->sortlist_valid = TRUE;
 }
 
@@ -860,14 +882,14 @@ static int symt_get_best_at(struct module* module, int idx_sorttab)
         symt_get_address(&module->addr_sorttab[idx_sorttab]->symt, &ref_addr);
         while (idx_sorttab > 0 &&
                module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol &&
-               !cmp_sorttab_addr(module, idx_sorttab - 1, ref_addr))
+               !cmp_sorted_addr(module, idx_sorttab - 1, ref_addr))
             idx_sorttab--;
         if (module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol)
         {
             idx_sorttab = idx_sorttab_orig;
             while (idx_sorttab < module->num_sorttab - 1 &&
                    module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol &&
-                   !cmp_sorttab_addr(module, idx_sorttab + 1, ref_addr))
+                   !cmp_sorted_addr(module, idx_sorttab + 1, ref_addr))
                 idx_sorttab++;
         }
         /* if no better symbol was found restore the original */
@@ -911,13 +933,13 @@ struct symt_ht* symt_find_nearest(struct module* module, DWORD_PTR addr)
     while (high > low + 1)
     {
         mid = (high + low) / 2;
-        if (cmp_sorttab_addr(module, mid, addr) < 0)
+        if (cmp_sorted_addr(module, mid, addr) < 0)
             low = mid;
         else
             high = mid;
     }
     if (low != high && high != module->num_sorttab &&
-        cmp_sorttab_addr(module, high, addr) <= 0)
+        cmp_sorted_addr(module, high, addr) <= 0)
         low = high;
 
     /* If found symbol is a public symbol, check if there are any other entries that
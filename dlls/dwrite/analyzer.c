@@ -30,6 +30,9 @@ WINE_DEFAULT_DEBUG_CHANNEL(dwrite);
 
 extern const unsigned short wine_linebreak_table[] DECLSPEC_HIDDEN;
 extern const unsigned short wine_scripts_table[] DECLSPEC_HIDDEN;
+extern const unsigned short bidi_direction_table[] DECLSPEC_HIDDEN;
+
+struct ascii_char_props ascii_char_props[0x80];
 
 /* Number of characters needed for LOCALE_SNATIVEDIGITS */
 #define NATIVE_DIGITS_LEN 11
@@ -296,32 +299,68 @@ static inline UINT16 get_char_script(WCHAR c)
     return script == Script_Inherited ? Script_Unknown : script;
 }
 
-static DWRITE_SCRIPT_ANALYSIS get_char_sa(WCHAR c)
+static DWRITE_SCRIPT_ANALYSIS lookup_char_sa(WCHAR c)
 {
     DWRITE_SCRIPT_ANALYSIS sa;
 
     sa.script = get_char_script(c);
     sa.shapes = iscntrlW(c) || c == 0x2028 /* LINE SEPARATOR */ || c == 0x2029 /* PARAGRAPH SEPARATOR */ ?
-        DWRITE_SCRIPT_SHAPES_NO_VISUAL : DWRITE_SCRIPT_SHAPES_DEFAULT;
+            DWRITE_SCRIPT_SHAPES_NO_VISUAL : DWRITE_SCRIPT_SHAPES_DEFAULT;
     return sa;
 }
 
-static HRESULT analyze_script(const WCHAR *text, UINT32 position, UINT32 length, IDWriteTextAnalysisSink *sink)
+static inline DWRITE_SCRIPT_ANALYSIS get_char_sa(WCHAR c)
 {
     DWRITE_SCRIPT_ANALYSIS sa;
+
+    if (c >= 0x80)
+        return lookup_char_sa(c);
+
+    sa.script = ascii_char_props[c].script;
+    sa.shapes = ascii_char_props[c].shapes;
+    return sa;
+}
+
+/* Most analyzed text is ASCII, gather everything the analyzer needs to know
+ * about these characters in a single table instead of going through the
+ * generic per property tables every time. */
+void init_ascii_char_props(void)
+{
+    DWRITE_SCRIPT_ANALYSIS sa;
+    WCHAR c;
+
+    for (c = 0; c < ARRAY_SIZE(ascii_char_props); c++)
+    {
+        sa = lookup_char_sa(c);
+        ascii_char_props[c].script = sa.script;
+        ascii_char_props[c].shapes = sa.shapes;
+        ascii_char_props[c].bidi_class = get_table_entry(bidi_direction_table, c);
+        ascii_char_props[c].break_class = get_table_entry(wine_linebreak_table, c);
+        ascii_char_props[c].is_whitespace = !!isspaceW(c);
+    }
+}
+
+static HRESULT analyze_script(const WCHAR *text, UINT32 position, UINT32 length, IDWriteTextAnalysisSink *sink)
+{
+    DWRITE_SCRIPT_ANALYSIS sa, prev_sa;
     UINT32 pos, i, seq_length;
 
     if (!length)
         return S_OK;
 
-    sa = get_char_sa(*text);
+    sa = prev_sa = get_char_sa(*text);
 
     pos = position;
     seq_length = 1;
 
     for (i = 1; i < length; i++)
     {
-        DWRITE_SCRIPT_ANALYSIS cur_sa = get_char_sa(text[i]);
+        DWRITE_SCRIPT_ANALYSIS cur_sa;
+
+        /* runs of the same character are common, e.g. spaces, don't look it up again */
+        if (text[i] != text[i-1])
+            prev_sa = get_char_sa(text[i]);
+        cur_sa = prev_sa;
 
         /* Unknown type is ignored when preceded or followed by another script */
         switch (sa.script) {
@@ -466,11 +505,19 @@ static HRESULT analyze_linebreaks(const WCHAR *text, UINT32 count, DWRITE_LINE_B
 
     for (i = 0; i < count; i++)
     {
-        break_class[i] = get_table_entry(wine_linebreak_table, text[i]);
+        if (text[i] < 0x80)
+        {
+            break_class[i] = ascii_char_props[text[i]].break_class;
+            breakpoints[i].isWhitespace = ascii_char_props[text[i]].is_whitespace;
+        }
+        else
+        {
+            break_class[i] = get_table_entry(wine_linebreak_table, text[i]);
+            breakpoints[i].isWhitespace = !!isspaceW(text[i]);
+        }
 
         breakpoints[i].breakConditionBefore = DWRITE_BREAK_CONDITION_NEUTRAL;
         breakpoints[i].breakConditionAfter  = DWRITE_BREAK_CONDITION_NEUTRAL;
-        breakpoints[i].isWhitespace = !!isspaceW(text[i]);
         breakpoints[i].isSoftHyphen = text[i] == 0x00ad /* Unicode Soft Hyphen */;
         breakpoints[i].padding = 0;
 
@@ -155,7 +155,12 @@ static void bidi_classify(const WCHAR *string, UINT8 *chartype, UINT32 count)
     UINT32 i;
 
     for (i = 0; i < count; ++i)
-        chartype[i] = get_table_entry( bidi_direction_table, string[i] );
+    {
+        if (string[i] < 0x80)
+            chartype[i] = ascii_char_props[string[i]].bidi_class;
+        else
+            chartype[i] = get_table_entry( bidi_direction_table, string[i] );
+    }
 }
 
 WCHAR bidi_get_mirrored_char(WCHAR ch)
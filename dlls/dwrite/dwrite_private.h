@@ -115,6 +115,18 @@ static inline unsigned short get_table_entry(const unsigned short *table, WCHAR
     return table[table[table[ch >> 8] + ((ch >> 4) & 0x0f)] + (ch & 0xf)];
 }
 
+/* Character properties used by the text analyzer, precomputed for ASCII range. */
+struct ascii_char_props
+{
+    UINT16 script;
+    UINT8 shapes;
+    UINT8 bidi_class;
+    UINT8 break_class;
+    UINT8 is_whitespace;
+};
+
+extern struct ascii_char_props ascii_char_props[0x80] DECLSPEC_HIDDEN;
+
 static inline FLOAT get_scaled_advance_width(INT32 advance, FLOAT emSize, const DWRITE_FONT_METRICS *metrics)
 {
     return (FLOAT)advance * emSize / (FLOAT)metrics->designUnitsPerEm;
@@ -214,6 +226,7 @@ struct dwrite_fontface
     struct dwrite_fonttable cpal;
     struct dwrite_fonttable colr;
     DWRITE_GLYPH_METRICS *glyphs[GLYPH_MAX/GLYPH_BLOCK_SIZE];
+    UINT16 *glyph_indices[GLYPH_MAX/GLYPH_BLOCK_SIZE];
 
     DWRITE_FONT_STYLE style;
     DWRITE_FONT_STRETCH stretch;
@@ -244,6 +257,7 @@ extern HRESULT get_eudc_fontcollection(IDWriteFactory7 *factory, IDWriteFontColl
 extern IDWriteTextAnalyzer *get_text_analyzer(void) DECLSPEC_HIDDEN;
 extern HRESULT create_font_file(IDWriteFontFileLoader *loader, const void *reference_key, UINT32 key_size, IDWriteFontFile **font_file) DECLSPEC_HIDDEN;
 extern void    init_local_fontfile_loader(void) DECLSPEC_HIDDEN;
+extern void    init_ascii_char_props(void) DECLSPEC_HIDDEN;
 extern IDWriteFontFileLoader *get_local_fontfile_loader(void) DECLSPEC_HIDDEN;
 extern HRESULT create_fontface(const struct fontface_desc *desc, struct list *cached_list,
         IDWriteFontFace5 **fontface) DECLSPEC_HIDDEN;
@@ -26,6 +26,7 @@
 #define COBJMACROS
 
 #include "dwrite_private.h"
+#include "wine/rbtree.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dwrite);
 WINE_DECLARE_DEBUG_CHANNEL(dwrite_file);
@@ -552,6 +553,8 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
 
         for (i = 0; i < ARRAY_SIZE(fontface->glyphs); i++)
             heap_free(fontface->glyphs[i]);
+        for (i = 0; i < ARRAY_SIZE(fontface->glyph_indices); i++)
+            heap_free(fontface->glyph_indices[i]);
 
         freetype_notify_cacheremove(iface);
 
@@ -671,9 +674,43 @@ static HRESULT WINAPI dwritefontface_GetDesignGlyphMetrics(IDWriteFontFace5 *ifa
     return S_OK;
 }
 
+/* BMP codepoints are mapped a block at a time, so that shaping the same text again doesn't
+   have to go through freetype for every character. */
+static UINT16 fontface_get_glyph(struct dwrite_fontface *fontface, UINT32 codepoint)
+{
+    UINT32 codepoints[GLYPH_BLOCK_SIZE], i;
+    UINT16 *block, glyph;
+
+    if (codepoint >= GLYPH_MAX) {
+        freetype_get_glyphs(&fontface->IDWriteFontFace5_iface, fontface->charmap, &codepoint, 1, &glyph);
+        return glyph;
+    }
+
+    if (!(block = fontface->glyph_indices[codepoint >> GLYPH_BLOCK_SHIFT])) {
+        if (!(block = heap_alloc(GLYPH_BLOCK_SIZE * sizeof(*block)))) {
+            freetype_get_glyphs(&fontface->IDWriteFontFace5_iface, fontface->charmap, &codepoint, 1, &glyph);
+            return glyph;
+        }
+
+        for (i = 0; i < GLYPH_BLOCK_SIZE; i++)
+            codepoints[i] = (codepoint & ~GLYPH_BLOCK_MASK) + i;
+        freetype_get_glyphs(&fontface->IDWriteFontFace5_iface, fontface->charmap, codepoints, GLYPH_BLOCK_SIZE, block);
+
+        if (InterlockedCompareExchangePointer((void **)&fontface->glyph_indices[codepoint >> GLYPH_BLOCK_SHIFT],
+                block, NULL)) {
+            heap_free(block);
+            block = fontface->glyph_indices[codepoint >> GLYPH_BLOCK_SHIFT];
+        }
+    }
+
+    return block[codepoint & GLYPH_BLOCK_MASK];
+}
+
 static HRESULT fontface_get_glyphs(struct dwrite_fontface *fontface, UINT32 const *codepoints,
         UINT32 count, UINT16 *glyphs)
 {
+    UINT32 i;
+
     if (!glyphs)
         return E_INVALIDARG;
 
@@ -682,7 +719,8 @@ static HRESULT fontface_get_glyphs(struct dwrite_fontface *fontface, UINT32 cons
         return E_INVALIDARG;
     }
 
-    freetype_get_glyphs(&fontface->IDWriteFontFace5_iface, fontface->charmap, codepoints, count, glyphs);
+    for (i = 0; i < count; i++)
+        glyphs[i] = fontface_get_glyph(fontface, codepoints[i]);
     return S_OK;
 }
 
@@ -3983,16 +4021,43 @@ static void fontcollection_add_replacements(struct dwrite_fontcollection *collec
     RegCloseKey(hkey);
 }
 
+struct fontfile_key
+{
+    const void *data;
+    UINT32 size;
+};
+
+struct scanned_fontfile
+{
+    struct wine_rb_entry entry;
+    struct fontfile_key key;
+    IDWriteFontFile *file;
+};
+
+static int scanned_fontfile_compare(const void *k, const struct wine_rb_entry *entry)
+{
+    const struct scanned_fontfile *scanned = WINE_RB_ENTRY_VALUE(entry, const struct scanned_fontfile, entry);
+    const struct fontfile_key *key = k;
+
+    if (key->size != scanned->key.size)
+        return key->size < scanned->key.size ? -1 : 1;
+    return memcmp(key->data, scanned->key.data, key->size);
+}
+
+static void release_scanned_fontfile(struct wine_rb_entry *entry, void *context)
+{
+    struct scanned_fontfile *scanned = WINE_RB_ENTRY_VALUE(entry, struct scanned_fontfile, entry);
+
+    IDWriteFontFile_Release(scanned->file);
+    heap_free(scanned);
+}
+
 HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerator *enumerator, BOOL is_system,
     IDWriteFontCollection3 **ret)
 {
-    struct fontfile_enum {
-        struct list entry;
-        IDWriteFontFile *file;
-    };
-    struct fontfile_enum *fileenum, *fileenum2;
     struct dwrite_fontcollection *collection;
-    struct list scannedfiles;
+    struct scanned_fontfile *scanned;
+    struct wine_rb_tree scannedfiles;
     BOOL current = FALSE;
     HRESULT hr = S_OK;
     size_t i;
@@ -4012,14 +4077,15 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
 
     TRACE("building font collection:\n");
 
-    list_init(&scannedfiles);
+    wine_rb_init(&scannedfiles, scanned_fontfile_compare);
     while (hr == S_OK) {
         DWRITE_FONT_FACE_TYPE face_type;
         DWRITE_FONT_FILE_TYPE file_type;
-        BOOL supported, same = FALSE;
         IDWriteFontFileStream *stream;
+        struct fontfile_key key;
         IDWriteFontFile *file;
         UINT32 face_count;
+        BOOL supported;
 
         current = FALSE;
         hr = IDWriteFontFileEnumerator_MoveNext(enumerator, &current);
@@ -4031,12 +4097,11 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
             break;
 
         /* check if we've scanned this file already */
-        LIST_FOR_EACH_ENTRY(fileenum, &scannedfiles, struct fontfile_enum, entry) {
-            if ((same = is_same_fontfile(fileenum->file, file)))
-                break;
+        if (FAILED(IDWriteFontFile_GetReferenceKey(file, &key.data, &key.size))) {
+            key.data = NULL;
+            key.size = 0;
         }
-
-        if (same) {
+        else if (wine_rb_get(&scannedfiles, &key)) {
             IDWriteFontFile_Release(file);
             continue;
         }
@@ -4056,10 +4121,13 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
             continue;
         }
 
-        /* add to scanned list */
-        fileenum = heap_alloc(sizeof(*fileenum));
-        fileenum->file = file;
-        list_add_tail(&scannedfiles, &fileenum->entry);
+        /* add to scanned files, keys are owned by the files */
+        if (key.data && (scanned = heap_alloc(sizeof(*scanned)))) {
+            scanned->key = key;
+            scanned->file = file;
+            wine_rb_put(&scannedfiles, &key, &scanned->entry);
+            IDWriteFontFile_AddRef(file);
+        }
 
         for (i = 0; i < face_count; i++) {
             IDWriteLocalizedStrings *family_name = NULL;
@@ -4121,13 +4189,10 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
         }
 
         IDWriteFontFileStream_Release(stream);
+        IDWriteFontFile_Release(file);
     }
 
-    LIST_FOR_EACH_ENTRY_SAFE(fileenum, fileenum2, &scannedfiles, struct fontfile_enum, entry) {
-        IDWriteFontFile_Release(fileenum->file);
-        list_remove(&fileenum->entry);
-        heap_free(fileenum);
-    }
+    wine_rb_destroy(&scannedfiles, release_scanned_fontfile, NULL);
 
     for (i = 0; i < collection->count; ++i)
     {
@@ -55,6 +55,30 @@ static FT_Library library = 0;
 static FTC_Manager cache_manager = 0;
 static FTC_CMapCache cmap_cache = 0;
 static FTC_ImageCache image_cache = 0;
+
+/* Rendered bitmaps of untransformed glyphs, so that drawing the same text again
+   doesn't have to rasterize outlines again. Protected by freetype_cs. */
+struct glyph_bitmap_entry
+{
+    struct list entry;          /* in most recently used order */
+    struct list bucket_entry;
+    void *fontface;
+    float emsize;
+    UINT16 glyph;
+    BOOL aliased;
+    BOOL is_1bpp;
+    INT pitch;
+    RECT bbox;
+    BYTE data[1];
+};
+
+#define GLYPH_BITMAP_CACHE_BUCKETS  64
+#define GLYPH_BITMAP_CACHE_MAX      512
+#define GLYPH_BITMAP_MAX_SIZE       4096
+
+static struct list glyph_bitmap_cache = LIST_INIT(glyph_bitmap_cache);
+static struct list glyph_bitmap_buckets[GLYPH_BITMAP_CACHE_BUCKETS];
+static unsigned int glyph_bitmap_count;
 typedef struct
 {
     FT_Int major;
@@ -178,6 +202,7 @@ fail:
 BOOL init_freetype(void)
 {
     FT_Version_t FT_Version;
+    unsigned int i;
 
     ft_handle = wine_dlopen(SONAME_LIBFREETYPE, RTLD_NOW, NULL, 0);
     if (!ft_handle) {
@@ -240,6 +265,9 @@ BOOL init_freetype(void)
         return FALSE;
     }
 
+    for (i = 0; i < GLYPH_BITMAP_CACHE_BUCKETS; i++)
+        list_init(&glyph_bitmap_buckets[i]);
+
     TRACE("FreeType version is %d.%d.%d\n", FT_Version.major, FT_Version.minor, FT_Version.patch);
     return TRUE;
 
@@ -250,15 +278,35 @@ sym_not_found:
     return FALSE;
 }
 
+static void free_glyph_bitmap_entry(struct glyph_bitmap_entry *cached)
+{
+    list_remove(&cached->entry);
+    list_remove(&cached->bucket_entry);
+    glyph_bitmap_count--;
+    heap_free(cached);
+}
+
 void release_freetype(void)
 {
+    struct glyph_bitmap_entry *cached, *cached2;
+
+    LIST_FOR_EACH_ENTRY_SAFE(cached, cached2, &glyph_bitmap_cache, struct glyph_bitmap_entry, entry)
+        free_glyph_bitmap_entry(cached);
+
     pFTC_Manager_Done(cache_manager);
     pFT_Done_FreeType(library);
 }
 
 void freetype_notify_cacheremove(IDWriteFontFace5 *fontface)
 {
+    struct glyph_bitmap_entry *cached, *cached2;
+
     EnterCriticalSection(&freetype_cs);
+    LIST_FOR_EACH_ENTRY_SAFE(cached, cached2, &glyph_bitmap_cache, struct glyph_bitmap_entry, entry)
+    {
+        if (cached->fontface == fontface)
+            free_glyph_bitmap_entry(cached);
+    }
     pFTC_Manager_RemoveFaceID(cache_manager, fontface);
     LeaveCriticalSection(&freetype_cs);
 }
@@ -808,6 +856,66 @@ static BOOL freetype_get_aa_glyph_bitmap(struct dwrite_glyphbitmap *bitmap, FT_G
     return ret;
 }
 
+static struct list *get_glyph_bitmap_bucket(const struct dwrite_glyphbitmap *bitmap)
+{
+    return &glyph_bitmap_buckets[(bitmap->glyph ^ ((ULONG_PTR)bitmap->fontface >> 4)) % GLYPH_BITMAP_CACHE_BUCKETS];
+}
+
+static BOOL get_cached_glyph_bitmap(struct dwrite_glyphbitmap *bitmap, BOOL *is_1bpp)
+{
+    struct glyph_bitmap_entry *cached;
+    struct list *bucket = get_glyph_bitmap_bucket(bitmap);
+
+    LIST_FOR_EACH_ENTRY(cached, bucket, struct glyph_bitmap_entry, bucket_entry)
+    {
+        if (cached->fontface != bitmap->fontface || cached->glyph != bitmap->glyph ||
+                cached->emsize != bitmap->emsize || cached->aliased != bitmap->aliased)
+            continue;
+        /* the glyph is about to be rendered again, drop the stale copy so
+         * that it gets replaced rather than duplicated */
+        if (cached->pitch != bitmap->pitch || !EqualRect(&cached->bbox, &bitmap->bbox)) {
+            free_glyph_bitmap_entry(cached);
+            return FALSE;
+        }
+
+        memcpy(bitmap->buf, cached->data, cached->pitch * (cached->bbox.bottom - cached->bbox.top));
+        *is_1bpp = cached->is_1bpp;
+        list_remove(&cached->entry);
+        list_add_head(&glyph_bitmap_cache, &cached->entry);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void cache_glyph_bitmap(const struct dwrite_glyphbitmap *bitmap, BOOL is_1bpp)
+{
+    struct glyph_bitmap_entry *cached;
+    UINT32 size = bitmap->pitch * (bitmap->bbox.bottom - bitmap->bbox.top);
+
+    if (size > GLYPH_BITMAP_MAX_SIZE)
+        return;
+
+    if (glyph_bitmap_count == GLYPH_BITMAP_CACHE_MAX)
+        free_glyph_bitmap_entry(LIST_ENTRY(list_tail(&glyph_bitmap_cache), struct glyph_bitmap_entry, entry));
+
+    if (!(cached = heap_alloc(FIELD_OFFSET(struct glyph_bitmap_entry, data[size]))))
+        return;
+
+    cached->fontface = bitmap->fontface;
+    cached->emsize = bitmap->emsize;
+    cached->glyph = bitmap->glyph;
+    cached->aliased = bitmap->aliased;
+    cached->is_1bpp = is_1bpp;
+    cached->pitch = bitmap->pitch;
+    cached->bbox = bitmap->bbox;
+    memcpy(cached->data, bitmap->buf, size);
+
+    list_add_head(&glyph_bitmap_cache, &cached->entry);
+    list_add_head(get_glyph_bitmap_bucket(bitmap), &cached->bucket_entry);
+    glyph_bitmap_count++;
+}
+
 BOOL freetype_get_glyph_bitmap(struct dwrite_glyphbitmap *bitmap)
 {
     FTC_ImageTypeRec imagetype;
@@ -820,6 +928,11 @@ BOOL freetype_get_glyph_bitmap(struct dwrite_glyphbitmap *bitmap)
 
     needs_transform = get_glyph_transform(bitmap, &m);
 
+    if (!needs_transform && get_cached_glyph_bitmap(bitmap, &ret)) {
+        LeaveCriticalSection(&freetype_cs);
+        return ret;
+    }
+
     imagetype.face_id = bitmap->fontface;
     imagetype.width = 0;
     imagetype.height = bitmap->emsize;
@@ -848,6 +961,9 @@ BOOL freetype_get_glyph_bitmap(struct dwrite_glyphbitmap *bitmap)
 
         if (glyph_copy)
             pFT_Done_Glyph(glyph_copy);
+
+        if (!needs_transform)
+            cache_glyph_bitmap(bitmap, ret);
     }
 
     LeaveCriticalSection(&freetype_cs);
@@ -45,6 +45,7 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD reason, LPVOID reserved)
         DisableThreadLibraryCalls( hinstDLL );
         init_freetype();
         init_local_fontfile_loader();
+        init_ascii_char_props();
         break;
     case DLL_PROCESS_DETACH:
         if (reserved) break;
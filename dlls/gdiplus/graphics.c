@@ -376,6 +376,35 @@ static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_
 
     GdipGetCompositingMode(graphics, &comp_mode);
 
+    if (dst_bitmap->format == PixelFormat32bppARGB)
+    {
+        /* Pixels can be accessed directly, skip the per-pixel Get/SetPixel calls. */
+        INT start_x = max(0, -dst_x), end_x = min(src_width, dst_bitmap->width - dst_x);
+        INT start_y = max(0, -dst_y), end_y = min(src_height, dst_bitmap->height - dst_y);
+
+        for (y=start_y; y<end_y; y++)
+        {
+            const ARGB *src_row = (const ARGB*)(src + src_stride * y);
+            ARGB *dst_row = (ARGB*)(dst_bitmap->bits + dst_bitmap->stride * (y + dst_y));
+
+            for (x=start_x; x<end_x; x++)
+            {
+                ARGB src_color = src_row[x];
+
+                if (comp_mode == CompositingModeSourceCopy)
+                    dst_row[x+dst_x] = src_color;
+                else if (!(src_color & 0xff000000))
+                    continue;
+                else if (fmt & PixelFormatPAlpha)
+                    dst_row[x+dst_x] = color_over_fgpremult(dst_row[x+dst_x], src_color);
+                else
+                    dst_row[x+dst_x] = color_over(dst_row[x+dst_x], src_color);
+            }
+        }
+
+        return Ok;
+    }
+
     for (y=0; y<src_height; y++)
     {
         for (x=0; x<src_width; x++)
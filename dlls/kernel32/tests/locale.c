@@ -1985,6 +1985,10 @@ static void test_CompareStringW(void)
     static const WCHAR A_ACUTE_BC[] = {0xc1,'B','C',0};
     static const WCHAR A_ACUTE_BC_DECOMP[] = {'A',0x301,'B','C',0};
     static const WCHAR A_NULL_BC[] = {'A',0,'B','C',0};
+    static const WCHAR ABC_A_ACUTE[] = {'A','B','C',0xe1,0};
+    static const WCHAR ABC_A_ACUTE_DECOMP[] = {'A','B','C','a',0x301,0};
+    static const WCHAR ABC_X[] = {'A','B','C','x',0};
+    static const WCHAR ABC_X_UPPER[] = {'A','B','C','X',0};
     WCHAR *str1, *str2;
     SYSTEM_INFO si;
     DWORD old_prot;
@@ -2051,6 +2055,15 @@ static void test_CompareStringW(void)
     ok(ret == CSTR_LESS_THAN, "expected CSTR_LESS_THAN, got %d\n", ret);
     ret = CompareStringW(CP_ACP, NORM_IGNORENONSPACE, A_NULL_BC, 4, A_ACUTE_BC_DECOMP, 5);
     todo_wine ok(ret == CSTR_EQUAL, "expected CSTR_EQUAL, got %d\n", ret);
+
+    ret = CompareStringW(CP_ACP, 0, ABC_A_ACUTE, -1, ABC_A_ACUTE_DECOMP, -1);
+    ok(ret == CSTR_EQUAL, "expected CSTR_EQUAL, got %d\n", ret);
+    ret = CompareStringW(CP_ACP, 0, ABC_X, -1, ABC_X_UPPER, -1);
+    ok(ret == CSTR_LESS_THAN, "expected CSTR_LESS_THAN, got %d\n", ret);
+    ret = CompareStringW(CP_ACP, NORM_IGNORECASE, ABC_X, -1, ABC_X_UPPER, -1);
+    ok(ret == CSTR_EQUAL, "expected CSTR_EQUAL, got %d\n", ret);
+    ret = CompareStringW(CP_ACP, 0, ABC_X, 3, ABC_X_UPPER, 4);
+    ok(ret == CSTR_LESS_THAN, "expected CSTR_LESS_THAN, got %d\n", ret);
 }
 
 struct comparestringex_test {
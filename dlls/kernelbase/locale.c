@@ -2728,6 +2728,16 @@ INT WINAPI CompareStringEx( const WCHAR *locale, DWORD flags, const WCHAR *str1,
     if (len1 < 0) len1 = lstrlenW(str1);
     if (len2 < 0) len2 = lstrlenW(str2);
 
+    /* printable ASCII chars don't decompose and have non-zero weights of all types,
+     * so a common prefix of them compares equal in every pass and can be skipped */
+    while (len1 && len2 && *str1 == *str2 && *str1 >= 0x20 && *str1 < 0x7f)
+    {
+        str1++;
+        str2++;
+        len1--;
+        len2--;
+    }
+
     ret = compare_weights( flags, str1, len1, str2, len2, UNICODE_WEIGHT );
     if (!ret)
     {
@@ -36,6 +36,7 @@
 #include "ntdll_misc.h"
 #include "wine/exception.h"
 #include "wine/debug.h"
+#include "wine/list.h"
 #include "wine/unicode.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(actctx);
@@ -50,6 +51,30 @@ WINE_DEFAULT_DEBUG_CHANNEL(actctx);
  ACTCTX_FLAG_SOURCE_IS_ASSEMBLYREF |\
  ACTCTX_FLAG_HMODULE_VALID )
 
+/* result of a manifest lookup in the winsxs directory */
+struct winsxs_lookup
+{
+    struct list entry;
+    WCHAR      *lookup;          /* file name pattern */
+    USHORT      build;           /* minimum version that was requested */
+    USHORT      revision;
+    USHORT      found_build;     /* version of the manifest that was found */
+    USHORT      found_revision;
+    WCHAR      *file;            /* manifest file name, NULL if not found */
+};
+
+static struct list winsxs_lookups = LIST_INIT( winsxs_lookups );
+static LARGE_INTEGER winsxs_lookups_time;
+
+static RTL_CRITICAL_SECTION winsxs_section;
+static RTL_CRITICAL_SECTION_DEBUG winsxs_critsect_debug =
+{
+    0, 0, &winsxs_section,
+    { &winsxs_critsect_debug.ProcessLocksList, &winsxs_critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": winsxs_section") }
+};
+static RTL_CRITICAL_SECTION winsxs_section = { &winsxs_critsect_debug, -1, 0, 0, 0, 0 };
+
 #define ACTCTX_MAGIC       0xC07E3E11
 #define STRSECTION_MAGIC   0x64487353 /* dHsS */
 #define GUIDSECTION_MAGIC  0x64487347 /* dHsG */
@@ -3080,29 +3105,16 @@ static NTSTATUS get_manifest_in_associated_manifest( struct actctx_loader* acl,
     return status;
 }
 
-static WCHAR *lookup_manifest_file( HANDLE dir, struct assembly_identity *ai )
+static WCHAR *find_manifest_file( HANDLE dir, struct assembly_identity *ai, const WCHAR *lookup )
 {
-    static const WCHAR lookup_fmtW[] =
-        {'%','s','_','%','s','_','%','s','_','%','u','.','%','u','.','*','.','*','_',
-         '%','s','_','*','.','m','a','n','i','f','e','s','t',0};
     static const WCHAR wine_trailerW[] = {'d','e','a','d','b','e','e','f','.','m','a','n','i','f','e','s','t'};
 
-    WCHAR *lookup, *ret = NULL;
+    WCHAR *ret = NULL;
     UNICODE_STRING lookup_us;
     IO_STATUS_BLOCK io;
-    const WCHAR *lang = ai->language;
     unsigned int data_pos = 0, data_len;
     char buffer[8192];
 
-    if (!lang || !strcmpiW( lang, neutralW )) lang = wildcardW;
-
-    if (!(lookup = RtlAllocateHeap( GetProcessHeap(), 0,
-                                    (strlenW(ai->arch) + strlenW(ai->name)
-                                     + strlenW(ai->public_key) + strlenW(lang) + 20) * sizeof(WCHAR)
-                                    + sizeof(lookup_fmtW) )))
-        return NULL;
-    sprintfW( lookup, lookup_fmtW, ai->arch, ai->name, ai->public_key,
-              ai->version.major, ai->version.minor, lang );
     RtlInitUnicodeString( &lookup_us, lookup );
 
     if (!NtQueryDirectoryFile( dir, 0, NULL, NULL, &io, buffer, sizeof(buffer),
@@ -3161,6 +3173,96 @@ static WCHAR *lookup_manifest_file( HANDLE dir, struct assembly_identity *ai )
         }
     }
     else WARN("no matching file for %s\n", debugstr_w(lookup));
+    return ret;
+}
+
+/* Looking up a manifest means enumerating the whole winsxs manifests
+ * directory, so remember the results until the directory is modified. */
+static WCHAR *lookup_manifest_file( HANDLE dir, struct assembly_identity *ai )
+{
+    static const WCHAR lookup_fmtW[] =
+        {'%','s','_','%','s','_','%','s','_','%','u','.','%','u','.','*','.','*','_',
+         '%','s','_','*','.','m','a','n','i','f','e','s','t',0};
+
+    struct winsxs_lookup *cached;
+    FILE_BASIC_INFORMATION info;
+    IO_STATUS_BLOCK io;
+    WCHAR *lookup, *ret = NULL;
+    const WCHAR *lang = ai->language;
+    USHORT build = ai->version.build, revision = ai->version.revision;
+    BOOL use_cache;
+
+    if (!lang || !strcmpiW( lang, neutralW )) lang = wildcardW;
+
+    if (!(lookup = RtlAllocateHeap( GetProcessHeap(), 0,
+                                    (strlenW(ai->arch) + strlenW(ai->name)
+                                     + strlenW(ai->public_key) + strlenW(lang) + 20) * sizeof(WCHAR)
+                                    + sizeof(lookup_fmtW) )))
+        return NULL;
+    sprintfW( lookup, lookup_fmtW, ai->arch, ai->name, ai->public_key,
+              ai->version.major, ai->version.minor, lang );
+
+    use_cache = !NtQueryInformationFile( dir, &io, &info, sizeof(info), FileBasicInformation );
+
+    if (use_cache)
+    {
+        RtlEnterCriticalSection( &winsxs_section );
+        if (info.LastWriteTime.QuadPart != winsxs_lookups_time.QuadPart)
+        {
+            struct winsxs_lookup *next;
+
+            LIST_FOR_EACH_ENTRY_SAFE( cached, next, &winsxs_lookups, struct winsxs_lookup, entry )
+            {
+                list_remove( &cached->entry );
+                RtlFreeHeap( GetProcessHeap(), 0, cached->lookup );
+                RtlFreeHeap( GetProcessHeap(), 0, cached->file );
+                RtlFreeHeap( GetProcessHeap(), 0, cached );
+            }
+            winsxs_lookups_time = info.LastWriteTime;
+        }
+        LIST_FOR_EACH_ENTRY( cached, &winsxs_lookups, struct winsxs_lookup, entry )
+        {
+            if (cached->build != build || cached->revision != revision) continue;
+            if (strcmpiW( cached->lookup, lookup )) continue;
+
+            TRACE( "found cached %s for %s\n", debugstr_w(cached->file), debugstr_w(lookup) );
+            if (cached->file && (ret = strdupW( cached->file )))
+            {
+                ai->version.build = cached->found_build;
+                ai->version.revision = cached->found_revision;
+            }
+            RtlLeaveCriticalSection( &winsxs_section );
+            RtlFreeHeap( GetProcessHeap(), 0, lookup );
+            return ret;
+        }
+        RtlLeaveCriticalSection( &winsxs_section );
+    }
+
+    ret = find_manifest_file( dir, ai, lookup );
+
+    if (use_cache && (cached = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*cached) )))
+    {
+        cached->lookup = lookup;
+        cached->build = build;
+        cached->revision = revision;
+        cached->found_build = ai->version.build;
+        cached->found_revision = ai->version.revision;
+        cached->file = NULL;
+        if (!ret || (cached->file = strdupW( ret )))
+        {
+            RtlEnterCriticalSection( &winsxs_section );
+            if (info.LastWriteTime.QuadPart == winsxs_lookups_time.QuadPart)
+            {
+                list_add_head( &winsxs_lookups, &cached->entry );
+                lookup = NULL;
+                cached = NULL;
+            }
+            RtlLeaveCriticalSection( &winsxs_section );
+        }
+        if (cached) RtlFreeHeap( GetProcessHeap(), 0, cached->file );
+        RtlFreeHeap( GetProcessHeap(), 0, cached );
+    }
+
     RtlFreeHeap( GetProcessHeap(), 0, lookup );
     return ret;
 }
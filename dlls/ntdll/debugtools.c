@@ -22,14 +22,28 @@
 #include "wine/port.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <signal.h>
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
 
 #include "wine/debug.h"
+#include "wine/library.h"
 #include "ntdll_misc.h"
 
 WINE_DECLARE_DEBUG_CHANNEL(pid);
@@ -44,6 +58,82 @@ static struct __wine_debug_channel *debug_options;
 
 static const char * const debug_classes[] = { "fixme", "err", "warn", "trace" };
 
+/* asynchronous output, enabled by setting WINEDEBUGLOG to the base name of the log file */
+
+#define ASYNC_SLOT_COUNT 4096      /* must be a power of 2 */
+#define ASYNC_STALL_TIMEOUT 5000   /* ms before giving up on a line whose thread can't be checked */
+
+struct async_slot
+{
+    unsigned int seq;   /* slot sequence number */
+    unsigned int owner; /* position that the thread id was recorded for */
+    int          tid;   /* Unix tid of the thread that claimed the slot */
+    unsigned int len;   /* length of the line */
+    char         data[sizeof(((struct debug_info *)0)->output)];
+};
+
+static int async_fd = -1;
+static struct async_slot *async_slots;
+static unsigned int async_head;     /* next slot to fill */
+static unsigned int async_tail;     /* next slot to write, only modified by the writer thread */
+static unsigned int async_flushed;  /* slots before this one have been written out */
+static unsigned int async_dropped;  /* number of lines dropped or never finished by their thread */
+static int async_waiting;           /* set while the writer thread waits for lines */
+static int async_flush_waiters;     /* number of threads waiting for async_flushed to move */
+
+#ifdef __linux__
+
+/* wait until *addr no longer contains val, timeout in ms or -1 */
+static void async_wait( int *addr, int val, int timeout )
+{
+    struct timespec ts;
+
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = (timeout % 1000) * 1000000;
+    syscall( __NR_futex, addr, 128 /* FUTEX_WAIT|FUTEX_PRIVATE_FLAG */, val,
+             timeout >= 0 ? &ts : NULL, 0, 0 );
+}
+
+static void async_wake( int *addr )
+{
+    syscall( __NR_futex, addr, 129 /* FUTEX_WAKE|FUTEX_PRIVATE_FLAG */, INT_MAX, NULL, 0, 0 );
+}
+
+#else  /* __linux__ */
+
+/* without futexes the writer thread waits on a pipe, and flushing polls */
+static int async_pipe[2] = { -1, -1 };
+
+static void async_wait( int *addr, int val, int timeout )
+{
+    struct pollfd pfd;
+    char buffer[64];
+
+    if (addr != &async_waiting)
+    {
+        usleep( 1000 );
+        return;
+    }
+    pfd.fd = async_pipe[0];
+    pfd.events = POLLIN;
+    if (*(volatile int *)addr == val && poll( &pfd, 1, timeout ) > 0)
+        while (read( async_pipe[0], buffer, sizeof(buffer) ) > 0) /* nothing */;
+}
+
+static void async_wake( int *addr )
+{
+    if (addr == &async_waiting) write( async_pipe[1], "", 1 );
+}
+
+#endif  /* __linux__ */
+
+/* wake up the writer thread if it is waiting for lines */
+static inline void wake_async_writer(void)
+{
+    if (*(volatile int *)&async_waiting && interlocked_xchg( &async_waiting, 0 ))
+        async_wake( &async_waiting );
+}
+
 /* get the debug info pointer for the current thread */
 static inline struct debug_info *get_info(void)
 {
@@ -65,6 +155,194 @@ static int append_output( struct debug_info *info, const char *str, size_t len )
     return len;
 }
 
+/* queue a line for the writer thread, or drop it if the queue is full
+ *
+ * Slots are claimed without locking: a slot is free for position pos when its
+ * sequence number is pos, and holds a line once the sequence is pos + 1. The
+ * writer thread then releases it for the next round with pos + ASYNC_SLOT_COUNT.
+ * A slot that the writer gave up on is marked with pos - 1 instead. */
+static void queue_async_output( struct debug_info *info, const char *str, unsigned int len )
+{
+    struct async_slot *slot;
+    unsigned int pos = async_head;
+    int diff;
+
+    for (;;)
+    {
+        slot = &async_slots[pos % ASYNC_SLOT_COUNT];
+        diff = (int)(*(volatile unsigned int *)&slot->seq - pos);
+        if (!diff)
+        {
+            if (interlocked_cmpxchg( (int *)&async_head, pos + 1, pos ) == pos) break;
+        }
+        else if (diff < 0)
+        {
+            interlocked_xchg_add( (int *)&async_dropped, 1 );
+            return;
+        }
+        pos = *(volatile unsigned int *)&async_head;
+    }
+#ifdef __linux__
+    /* let the writer tell a thread that was killed from one that is merely slow */
+    if (!info->unix_tid) info->unix_tid = syscall( __NR_gettid );
+    slot->tid = info->unix_tid;
+    interlocked_xchg( (int *)&slot->owner, pos );
+#endif
+    memcpy( slot->data, str, len );
+    slot->len = len;
+    if (interlocked_cmpxchg( (int *)&slot->seq, pos + 1, pos ) != pos)
+    {
+        /* the line was skipped meanwhile, release the slot ourselves */
+        interlocked_cmpxchg( (int *)&slot->seq, pos + ASYNC_SLOT_COUNT, pos - 1 );
+    }
+    wake_async_writer();
+}
+
+/* check whether the thread that claimed a slot is gone without publishing its line */
+static BOOL async_slot_abandoned( struct async_slot *slot, unsigned int pos, DWORD stall_start )
+{
+#ifdef __linux__
+    if (interlocked_cmpxchg( (int *)&slot->owner, 0, 0 ) == pos)
+        return syscall( __NR_tgkill, getpid(), slot->tid, 0 ) == -1 && errno == ESRCH;
+#endif
+    return NtGetTickCount() - stall_start >= ASYNC_STALL_TIMEOUT;
+}
+
+/* writer thread, batching the queued lines into as few writes as possible */
+static void *async_output_thread( void *arg )
+{
+    static char buffer[65536];
+    unsigned int tail, seq, pos = 0, dropped = 0, count, stall_tail = 0;
+    DWORD stall_start = 0;
+    struct async_slot *slot;
+    int timeout;
+
+    for (;;)
+    {
+        tail = async_tail;
+        slot = &async_slots[tail % ASYNC_SLOT_COUNT];
+        seq = interlocked_cmpxchg( (int *)&slot->seq, 0, 0 );
+        if (seq == tail + 1)
+        {
+            if (pos + slot->len > sizeof(buffer))
+            {
+                write( async_fd, buffer, pos );
+                pos = 0;
+            }
+            memcpy( buffer + pos, slot->data, slot->len );
+            pos += slot->len;
+            interlocked_xchg( (int *)&slot->seq, tail + ASYNC_SLOT_COUNT );
+            async_tail = tail + 1;
+            continue;
+        }
+        if (seq == tail - ASYNC_SLOT_COUNT - 1)
+        {
+            /* skipped in the previous round and never released, the thread is gone */
+            interlocked_cmpxchg( (int *)&slot->seq, tail, seq );
+            continue;
+        }
+
+        timeout = -1;
+        if (seq == tail && *(volatile unsigned int *)&async_head != tail)
+        {
+            /* the slot has been claimed but its line not published yet, only skip
+             * it if the thread has been killed in the meantime */
+            if (stall_tail != tail || !stall_start)
+            {
+                stall_tail = tail;
+                stall_start = NtGetTickCount() | 1;
+            }
+            else if (async_slot_abandoned( slot, tail, stall_start ) &&
+                     interlocked_cmpxchg( (int *)&slot->seq, tail - 1, tail ) == tail)
+            {
+                interlocked_xchg_add( (int *)&async_dropped, 1 );
+                async_tail = tail + 1;
+                continue;
+            }
+            timeout = 10;
+        }
+
+        if (pos) write( async_fd, buffer, pos );
+        pos = 0;
+        if ((count = async_dropped) != dropped)
+        {
+            char msg[64];
+
+            sprintf( msg, "wine_dbg_output: %u lines dropped\n", count - dropped );
+            write( async_fd, msg, strlen( msg ));
+            dropped = count;
+        }
+        interlocked_xchg( (int *)&async_flushed, tail );
+        if (*(volatile int *)&async_flush_waiters) async_wake( (int *)&async_flushed );
+
+        /* check the slot again once waiting is advertised, so that no wakeup gets lost */
+        interlocked_xchg( &async_waiting, 1 );
+        if (interlocked_cmpxchg( (int *)&slot->seq, 0, 0 ) == seq)
+            async_wait( &async_waiting, 1, timeout );
+        async_waiting = 0;
+    }
+    return NULL;
+}
+
+/***********************************************************************
+ *		debug_init_log
+ *
+ * Open the per-process log file and start the writer thread. This needs
+ * the process id, so it runs once the server connection is set up.
+ */
+void debug_init_log(void)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+    sigset_t sigset, old_set;
+    const char *name = getenv( "WINEDEBUGLOG" );
+    char *path;
+    unsigned int i;
+    int ret;
+
+    if (!name || !*name) return;
+    if (!(path = RtlAllocateHeap( GetProcessHeap(), 0, strlen( name ) + 10 ))) return;
+    sprintf( path, "%s.%04x", name, GetCurrentProcessId() );
+    async_fd = open( path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0666 );
+    if (async_fd == -1) fprintf( stderr, "wine: failed to open debug log %s\n", path );
+    RtlFreeHeap( GetProcessHeap(), 0, path );
+    if (async_fd == -1) return;
+    fcntl( async_fd, F_SETFD, FD_CLOEXEC );
+
+#ifndef __linux__
+    if (pipe( async_pipe ) == -1) goto error;
+    for (i = 0; i < 2; i++)
+    {
+        fcntl( async_pipe[i], F_SETFD, FD_CLOEXEC );
+        fcntl( async_pipe[i], F_SETFL, O_NONBLOCK );
+    }
+#endif
+
+    async_slots = wine_anon_mmap( NULL, ASYNC_SLOT_COUNT * sizeof(*async_slots), PROT_READ | PROT_WRITE, 0 );
+    if (async_slots == (void *)-1) goto error;
+    for (i = 0; i < ASYNC_SLOT_COUNT; i++) async_slots[i].seq = i;
+
+    /* the writer thread has no TEB, make sure that it never runs a signal handler */
+    sigfillset( &sigset );
+    pthread_sigmask( SIG_BLOCK, &sigset, &old_set );
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    ret = pthread_create( &thread, &attr, async_output_thread, NULL );
+    pthread_attr_destroy( &attr );
+    pthread_sigmask( SIG_SETMASK, &old_set, NULL );
+    if (!ret) return;
+
+    munmap( async_slots, ASYNC_SLOT_COUNT * sizeof(*async_slots) );
+error:
+    fprintf( stderr, "wine: failed to start debug log writer\n" );
+#ifndef __linux__
+    close( async_pipe[0] );
+    close( async_pipe[1] );
+#endif
+    close( async_fd );
+    async_fd = -1;
+}
+
 /* add a new debug option at the end of the option list */
 static void add_option( const char *name, unsigned char set, unsigned char clear )
 {
@@ -239,7 +517,8 @@ int __cdecl __wine_dbg_output( const char *str )
     if (end)
     {
         ret += append_output( info, str, end + 1 - str );
-        write( 2, info->output, info->out_pos );
+        if (async_fd != -1) queue_async_output( info, info->output, info->out_pos );
+        else write( 2, info->output, info->out_pos );
         info->out_pos = 0;
         str = end + 1;
     }
@@ -289,3 +568,29 @@ void debug_init(void)
     ntdll_get_thread_data()->debug_info = &initial_info;
     init_done = TRUE;
 }
+
+/***********************************************************************
+ *		debug_flush
+ *
+ * Wait for the writer thread to write out the queued lines, for at most
+ * timeout ms since lines of suspended threads may never show up.
+ */
+void debug_flush( unsigned int timeout )
+{
+    DWORD start = NtGetTickCount(), elapsed;
+    unsigned int flushed;
+
+    if (async_fd == -1) return;
+
+    interlocked_xchg_add( &async_flush_waiters, 1 );
+    for (;;)
+    {
+        flushed = *(volatile unsigned int *)&async_flushed;
+        if (flushed == *(volatile unsigned int *)&async_head) break;
+        if ((elapsed = NtGetTickCount() - start) >= timeout) break;
+        /* the writer may be asleep in front of a line whose thread is gone */
+        wake_async_writer();
+        async_wait( (int *)&async_flushed, flushed, min( timeout - elapsed, 10 ));
+    }
+    interlocked_xchg_add( &async_flush_waiters, -1 );
+}
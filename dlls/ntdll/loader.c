@@ -720,7 +720,7 @@ static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY
         const WCHAR *user = current_modref ? current_modref->ldr.BaseDllName.Buffer : NULL;
         proc = SNOOP_GetProcAddress( module, exports, exp_size, proc, ordinal, user );
     }
-    if (TRACE_ON(relay))
+    if (RELAY_IsEnabled())
     {
         const WCHAR *user = current_modref ? current_modref->ldr.BaseDllName.Buffer : NULL;
         proc = RELAY_GetProcAddress( module, exports, exp_size, proc, ordinal, user );
@@ -1969,7 +1969,7 @@ static void load_builtin_callback( void *module, const char *filename )
     SERVER_END_REQ;
 
     /* setup relay debugging entry points */
-    if (TRACE_ON(relay)) RELAY_SetupDLL( module );
+    if (RELAY_IsEnabled()) RELAY_SetupDLL( module );
 }
 
 
@@ -2624,7 +2624,7 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, const UNICODE_STRING *nt_nam
 
     if (image_info->image_flags & IMAGE_FLAGS_WineBuiltin)
     {
-        if (TRACE_ON(relay)) RELAY_SetupDLL( *module );
+        if (RELAY_IsEnabled()) RELAY_SetupDLL( *module );
     }
     else
     {
@@ -3752,7 +3752,9 @@ void WINAPI RtlExitUserProcess( DWORD status )
     RtlEnterCriticalSection( &loader_section );
     RtlAcquirePebLock();
     NtTerminateProcess( 0, status );
+    profile_write();
     LdrShutdownProcess();
+    debug_flush( 1000 );
     NtTerminateProcess( GetCurrentProcess(), status );
     exit( get_unix_exit_code( status ));
 }
@@ -4498,6 +4500,8 @@ void __wine_process_init(void)
     peb->ProcessHeap = RtlCreateHeap( HEAP_GROWABLE, NULL, 0, 0, NULL, NULL );
     peb->LoaderLock = &loader_section;
 
+    debug_init_log();
+
     fsync_init();
 
     esync_init();
@@ -1319,6 +1319,33 @@ found:
 }
 
 
+/* length of the 7-bit ASCII run at the start of a UTF-8 string, four chars at a time */
+static inline unsigned int get_ascii_run_mbs( const char *src, unsigned int srclen )
+{
+    unsigned int pos, chars;
+
+    for (pos = 0; pos + 4 <= srclen; pos += 4)
+    {
+        memcpy( &chars, src + pos, sizeof(chars) );
+        if (chars & 0x80808080) break;
+    }
+    return pos;
+}
+
+/* length of the 7-bit ASCII run at the start of a wide char string, four chars at a time */
+static inline unsigned int get_ascii_run_wcs( const WCHAR *src, unsigned int srclen )
+{
+    unsigned int pos, chars[2];
+
+    for (pos = 0; pos + 4 <= srclen; pos += 4)
+    {
+        memcpy( chars, src + pos, sizeof(chars) );
+        if ((chars[0] | chars[1]) & 0xff80ff80) break;
+    }
+    return pos;
+}
+
+
 /* helper for the various utf8 mbstowcs functions */
 static unsigned int decode_utf8_char( unsigned char ch, const char **str, const char *strend )
 {
@@ -1392,7 +1419,13 @@ NTSTATUS WINAPI RtlUTF8ToUnicodeN( WCHAR *dst, DWORD dstlen, DWORD *reslen, cons
         for (len = 0; src < srcend; len++)
         {
             unsigned char ch = *src++;
-            if (ch < 0x80) continue;
+            if (ch < 0x80)
+            {
+                unsigned int run = get_ascii_run_mbs( src, srcend - src );
+                len += run;
+                src += run;
+                continue;
+            }
             if ((res = decode_utf8_char( ch, &src, srcend )) > 0x10ffff)
                 status = STATUS_SOME_NOT_MAPPED;
             else
@@ -1407,7 +1440,13 @@ NTSTATUS WINAPI RtlUTF8ToUnicodeN( WCHAR *dst, DWORD dstlen, DWORD *reslen, cons
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
+            unsigned int i, run;
+
             *dst++ = ch;
+            run = get_ascii_run_mbs( src, min( srcend - src, dstend - dst ));
+            for (i = 0; i < run; i++) dst[i] = src[i];
+            dst += run;
+            src += run;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
@@ -1467,7 +1506,13 @@ NTSTATUS WINAPI RtlUnicodeToUTF8N( char *dst, DWORD dstlen, DWORD *reslen, const
     {
         for (len = 0; srclen; srclen--, src++)
         {
-            if (*src < 0x80) len++;  /* 0x00-0x7f: 1 byte */
+            if (*src < 0x80)  /* 0x00-0x7f: 1 byte */
+            {
+                unsigned int run = get_ascii_run_wcs( src + 1, srclen - 1 );
+                len += run + 1;
+                src += run;
+                srclen -= run;
+            }
             else if (*src < 0x800) len += 2;  /* 0x80-0x7ff: 2 bytes */
             else
             {
@@ -1495,8 +1540,15 @@ NTSTATUS WINAPI RtlUnicodeToUTF8N( char *dst, DWORD dstlen, DWORD *reslen, const
 
         if (ch < 0x80)  /* 0x00-0x7f: 1 byte */
         {
+            unsigned int i, run;
+
             if (dst > end - 1) break;
             *dst++ = ch;
+            run = get_ascii_run_wcs( src + 1, min( srclen - 1, end - dst ));
+            for (i = 0; i < run; i++) dst[i] = src[i + 1];
+            dst += run;
+            src += run;
+            srclen -= run;
             continue;
         }
         if (ch < 0x800)  /* 0x80-0x7ff: 2 bytes */
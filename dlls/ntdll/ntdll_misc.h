@@ -80,6 +80,13 @@ extern void DECLSPEC_NORETURN signal_exit_thread( int status ) DECLSPEC_HIDDEN;
 extern void DECLSPEC_NORETURN signal_exit_process( int status ) DECLSPEC_HIDDEN;
 extern void version_init(void) DECLSPEC_HIDDEN;
 extern void debug_init(void) DECLSPEC_HIDDEN;
+extern void debug_init_log(void) DECLSPEC_HIDDEN;
+extern void debug_flush( unsigned int timeout ) DECLSPEC_HIDDEN;
+extern BOOL profile_init(void) DECLSPEC_HIDDEN;
+extern void profile_start(void) DECLSPEC_HIDDEN;
+extern void profile_add_sample( TEB *teb, void *pc, void *frame ) DECLSPEC_HIDDEN;
+extern void profile_write(void) DECLSPEC_HIDDEN;
+extern void profile_abort(void) DECLSPEC_HIDDEN;
 extern TEB *thread_init(void) DECLSPEC_HIDDEN;
 extern void actctx_init(void) DECLSPEC_HIDDEN;
 extern void virtual_init(void) DECLSPEC_HIDDEN;
@@ -126,6 +133,8 @@ extern FARPROC RELAY_GetProcAddress( HMODULE module, const IMAGE_EXPORT_DIRECTOR
 extern FARPROC SNOOP_GetProcAddress( HMODULE hmod, const IMAGE_EXPORT_DIRECTORY *exports, DWORD exp_size,
                                      FARPROC origfun, DWORD ordinal, const WCHAR *user ) DECLSPEC_HIDDEN;
 extern void RELAY_SetupDLL( HMODULE hmod ) DECLSPEC_HIDDEN;
+extern BOOL RELAY_IsEnabled(void) DECLSPEC_HIDDEN;
+extern void RELAY_FreeThreadLog( TEB *teb ) DECLSPEC_HIDDEN;
 extern void SNOOP_SetupDLL( HMODULE hmod ) DECLSPEC_HIDDEN;
 extern const WCHAR system_dir[] DECLSPEC_HIDDEN;
 extern const WCHAR syswow64_dir[] DECLSPEC_HIDDEN;
@@ -270,6 +279,7 @@ struct debug_info
 {
     unsigned int str_pos;       /* current position in strings buffer */
     unsigned int out_pos;       /* current position in output buffer */
+    int          unix_tid;      /* Unix tid of the thread, set on first asynchronous output */
     char         strings[1024]; /* buffer for temporary strings */
     char         output[1024];  /* current output line */
 };
@@ -287,6 +297,7 @@ struct ntdll_thread_data
     int                esync_queue_fd;/* fd to wait on for driver events */
     int                esync_apc_fd;  /* fd to wait on for user APCs */
     int               *fsync_apc_futex;
+    struct relay_log_chunk *relay_log; /* binary relay log chunk */
 };
 
 C_ASSERT( sizeof(struct ntdll_thread_data) <= sizeof(((TEB *)0)->GdiTebBatch) );
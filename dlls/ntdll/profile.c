@@ -0,0 +1,530 @@
+/*
+ * Sampling profiler
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * When the WINEPROFILE environment variable is set, the call stack of the
+ * thread running when SIGPROF is delivered is recorded, and at process exit
+ * the samples are written in the collapsed stack format used by flame graph
+ * tools to a file named after WINEPROFILE and the process id:
+ *
+ *   module!caller;module!function count
+ *
+ * The stack is walked by following the saved frame pointers, so callers of
+ * code built without them are missing. Samples are grouped by the start of
+ * the function containing them, found with the ELF symbol table or the
+ * unwind data. Functions without a symbol are written as
+ * module!symbol+0xoffset, or module+0xoffset when there is no symbol at all,
+ * so that they can be resolved offline.
+ *
+ * When the process is killed or aborted, the samples are written without
+ * any symbol lookup, as raw addresses, since the loader data may be in an
+ * inconsistent state. On Linux the memory map of the process is saved to a
+ * .maps file next to the profile to resolve them offline.
+ *
+ * WINEPROFILE_INTERVAL sets the sampling interval in microseconds of
+ * process CPU time, it defaults to 1000.
+ */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_TIME_H
+# include <sys/time.h>
+#endif
+#ifdef HAVE_DLFCN_H
+# include <dlfcn.h>
+#endif
+#ifdef HAVE_LINK_H
+# include <link.h>
+#endif
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winternl.h"
+#include "wine/debug.h"
+#include "wine/library.h"
+
+#include "ntdll_misc.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(profile);
+
+#define MAX_SAMPLE_WORDS (8 * 1024 * 1024)
+#define MAX_FRAMES       64
+
+static char *profile_path;
+static void **samples;   /* for each sample, the frame count then the frames, innermost first */
+static int sample_words;
+static int dropped_samples;
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+struct dwarf_eh_bases
+{
+    void *tbase;
+    void *dbase;
+    void *func;
+};
+extern const void *_Unwind_Find_FDE( void *, struct dwarf_eh_bases * );
+#endif
+
+/***********************************************************************
+ *           profile_init
+ *
+ * Check whether profiling is requested, and allocate the sample buffer.
+ */
+BOOL profile_init(void)
+{
+    const char *output = getenv( "WINEPROFILE" );
+
+    if (!output || !*output) return FALSE;
+
+    /* the variable is inherited by child processes, each of them needs its own file */
+    if (!(profile_path = RtlAllocateHeap( GetProcessHeap(), 0, strlen( output ) + 16 ))) return FALSE;
+    sprintf( profile_path, "%s.%04x", output, GetCurrentProcessId() );
+
+    samples = wine_anon_mmap( NULL, MAX_SAMPLE_WORDS * sizeof(*samples), PROT_READ | PROT_WRITE, 0 );
+    if (samples == (void *)-1)
+    {
+        ERR( "failed to allocate sample buffer\n" );
+        samples = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/***********************************************************************
+ *           profile_start
+ */
+void profile_start(void)
+{
+#ifdef HAVE_SYS_TIME_H
+    struct itimerval timer;
+    const char *interval = getenv( "WINEPROFILE_INTERVAL" );
+    long usec = interval ? atol( interval ) : 0;
+
+    if (usec <= 0) usec = 1000;
+    timer.it_interval.tv_sec = usec / 1000000;
+    timer.it_interval.tv_usec = usec % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer( ITIMER_PROF, &timer, NULL ) == -1) ERR( "failed to start profiling timer\n" );
+#else
+    FIXME( "profiling not supported on this platform\n" );
+#endif
+}
+
+static void profile_stop(void)
+{
+#ifdef HAVE_SYS_TIME_H
+    struct itimerval timer;
+
+    memset( &timer, 0, sizeof(timer) );
+    setitimer( ITIMER_PROF, &timer, NULL );
+#endif
+}
+
+/***********************************************************************
+ *           profile_add_sample
+ *
+ * Called from the SIGPROF handler, with the frame pointer of the interrupted
+ * code. teb is NULL for threads not created by Wine, only pc is recorded then.
+ */
+void profile_add_sample( TEB *teb, void *pc, void *frame )
+{
+    void *stack[MAX_FRAMES], **buffer = samples, **fp = frame, **next;
+    int idx, depth = 0;
+
+    if (!buffer) return;
+    if (sample_words >= MAX_SAMPLE_WORDS)
+    {
+        interlocked_xchg_add( &dropped_samples, 1 );
+        return;
+    }
+
+    stack[depth++] = pc;
+    /* each frame must be inside the thread stack and above the previous one,
+     * so a frame pointer used as a general register can't send us astray */
+    while (teb && depth < MAX_FRAMES && !((ULONG_PTR)fp & (sizeof(*fp) - 1)) &&
+           (char *)fp >= (char *)teb->Tib.StackLimit && (char *)(fp + 2) <= (char *)teb->Tib.StackBase)
+    {
+        if (!fp[1]) break;
+        stack[depth++] = fp[1];
+        if ((next = fp[0]) <= fp) break;
+        fp = next;
+    }
+
+    idx = interlocked_xchg_add( &sample_words, depth + 1 );
+    if (idx < 0 || idx > MAX_SAMPLE_WORDS - depth - 1)
+    {
+        interlocked_xchg_add( &dropped_samples, 1 );
+        return;
+    }
+    memcpy( buffer + idx + 1, stack, depth * sizeof(*stack) );
+    buffer[idx] = (void *)(ULONG_PTR)depth;
+}
+
+/* return the number of frames of the sample at pos, or 0 if the rest of the buffer isn't valid */
+static int get_sample_depth( int pos, int total )
+{
+    ULONG_PTR depth = (ULONG_PTR)samples[pos];
+
+    if (!depth || depth > MAX_FRAMES || depth >= total - pos) return 0;
+    return depth;
+}
+
+/* write the raw samples, without touching any lock; only async-signal-safe calls are allowed */
+static void write_raw_samples( int fd, int total )
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[MAX_FRAMES * (2 * sizeof(void *) + 3) + 4], *p;
+    ULONG_PTR addr;
+    int pos, depth, i, shift;
+
+    for (pos = 0; pos < total && (depth = get_sample_depth( pos, total )); pos += depth + 1)
+    {
+        p = line;
+        for (i = depth; i > 0; i--)
+        {
+            addr = (ULONG_PTR)samples[pos + i];
+            *p++ = '0';
+            *p++ = 'x';
+            for (shift = 8 * sizeof(addr) - 4; shift > 0 && !(addr >> shift); shift -= 4) ;
+            for ( ; shift >= 0; shift -= 4) *p++ = hex[(addr >> shift) & 0xf];
+            *p++ = i > 1 ? ';' : ' ';
+        }
+        *p++ = '1';
+        *p++ = '\n';
+        write( fd, line, p - line );
+    }
+}
+
+/***********************************************************************
+ *           profile_abort
+ *
+ * Write out the raw samples when the process is killed or aborted. Other
+ * threads may have been terminated anywhere, so no lock can be taken.
+ */
+void profile_abort(void)
+{
+    int fd;
+
+    if (!samples) return;
+    profile_stop();
+
+    if ((fd = open( profile_path, O_WRONLY | O_CREAT | O_TRUNC, 0666 )) != -1)
+    {
+        write_raw_samples( fd, min( sample_words, MAX_SAMPLE_WORDS ));
+        close( fd );
+    }
+
+#ifdef __linux__
+    {
+        char *maps = profile_path + strlen( profile_path );
+        char data[4096];
+        ssize_t size;
+        int in;
+
+        /* profile_init() allocated room for the suffix */
+        strcpy( maps, ".maps" );
+        if ((in = open( "/proc/self/maps", O_RDONLY )) != -1)
+        {
+            if ((fd = open( profile_path, O_WRONLY | O_CREAT | O_TRUNC, 0666 )) != -1)
+            {
+                while ((size = read( in, data, sizeof(data) )) > 0) write( fd, data, size );
+                close( fd );
+            }
+            close( in );
+        }
+        *maps = 0;
+    }
+#endif
+    samples = NULL;
+}
+
+struct frame_info
+{
+    void *pc;     /* code address */
+    void *func;   /* start of the function containing it */
+    char *name;   /* collapsed stack frame name of the function */
+};
+
+static int compare_pcs( const void *a, const void *b )
+{
+    const char *pc1 = *(void * const *)a, *pc2 = *(void * const *)b;
+
+    if (pc1 == pc2) return 0;
+    return pc1 < pc2 ? -1 : 1;
+}
+
+static int compare_frame_pcs( const void *a, const void *b )
+{
+    const struct frame_info *frame1 = a, *frame2 = b;
+
+    return compare_pcs( &frame1->pc, &frame2->pc );
+}
+
+static int compare_frame_funcs( const void *a, const void *b )
+{
+    const struct frame_info *frame1 = a, *frame2 = b;
+
+    return compare_pcs( &frame1->func, &frame2->func );
+}
+
+/* sort the samples by call stack so that identical ones end up next to each other */
+static int compare_stacks( const void *a, const void *b )
+{
+    void **stack1 = samples + *(const int *)a, **stack2 = samples + *(const int *)b;
+    ULONG_PTR i, depth = min( (ULONG_PTR)stack1[0], (ULONG_PTR)stack2[0] );
+    int ret;
+
+    for (i = 1; i <= depth; i++)
+        if ((ret = compare_pcs( &stack1[i], &stack2[i] ))) return ret;
+    return compare_pcs( &stack1[0], &stack2[0] );
+}
+
+/* find the start of the function containing pc, or return pc if it can't be found */
+static void *get_function_start( void *pc )
+{
+#ifdef HAVE_DLADDR1
+    Dl_info info;
+    ElfW(Sym) *sym = NULL;
+#endif
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    struct dwarf_eh_bases bases;
+#endif
+#ifdef __x86_64__
+    RUNTIME_FUNCTION *func;
+    LDR_MODULE *module;
+    ULONG_PTR base;
+#endif
+
+#ifdef HAVE_DLADDR1
+    /* dladdr() returns the closest symbol below pc, make sure that pc is inside it */
+    if (dladdr1( pc, &info, (void **)&sym, RTLD_DL_SYMENT ) && sym && info.dli_saddr &&
+        (char *)pc < (char *)info.dli_saddr + sym->st_size)
+        return info.dli_saddr;
+#endif
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    /* static functions of ELF code have no symbol, but they have unwind data */
+    if (_Unwind_Find_FDE( pc, &bases )) return bases.func;
+#endif
+#ifdef __x86_64__
+    if ((func = lookup_function_info( (ULONG_PTR)pc, &base, &module )))
+        return (char *)base + func->BeginAddress;
+#endif
+    return pc;
+}
+
+/* find the closest export below pc */
+static const char *find_export_name( HMODULE module, const char *pc, const char **addr )
+{
+    const IMAGE_EXPORT_DIRECTORY *exports;
+    const DWORD *functions, *names;
+    const WORD *ordinals;
+    const char *best = NULL, *best_name = NULL, *func;
+    ULONG size;
+    DWORD i;
+
+    *addr = NULL;
+    if (!(exports = RtlImageDirectoryEntryToData( module, TRUE, IMAGE_DIRECTORY_ENTRY_EXPORT, &size )))
+        return NULL;
+
+    functions = (const DWORD *)((const char *)module + exports->AddressOfFunctions);
+    names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    ordinals = (const WORD *)((const char *)module + exports->AddressOfNameOrdinals);
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        if (ordinals[i] >= exports->NumberOfFunctions) continue;
+        func = (const char *)module + functions[ordinals[i]];
+        /* skip forwarded exports, their address points into the export directory */
+        if (func >= (const char *)exports && func < (const char *)exports + size) continue;
+        if (func > pc || func <= best) continue;
+        best = func;
+        best_name = (const char *)module + names[i];
+    }
+    *addr = best;
+    return best_name;
+}
+
+static void format_frame_name( char *buffer, size_t size, const char *module, const char *symbol,
+                               const char *symbol_addr, const char *base, const char *func )
+{
+    if (symbol && symbol_addr == func)
+        snprintf( buffer, size, "%s!%s", module, symbol );
+    else if (symbol)
+        snprintf( buffer, size, "%s!%s+0x%lx", module, symbol, (unsigned long)(func - symbol_addr) );
+    else
+        snprintf( buffer, size, "%s+0x%lx", module, (unsigned long)(func - base) );
+}
+
+/* build the collapsed stack frame name of the function starting at func */
+static char *get_frame_name( void *func )
+{
+    char buffer[1024], *ret;
+    LDR_MODULE *ldr;
+    const char *name, *addr;
+#ifdef HAVE_DLADDR
+    Dl_info info;
+#endif
+
+#ifdef HAVE_DLADDR
+    if (dladdr( func, &info ) && info.dli_fname)
+    {
+        name = strrchr( info.dli_fname, '/' );
+        format_frame_name( buffer, sizeof(buffer), name ? name + 1 : info.dli_fname, info.dli_sname,
+                           info.dli_saddr, info.dli_fbase, func );
+    }
+    else
+#endif
+    if (!LdrFindEntryForAddress( func, &ldr ))
+    {
+        char module[MAX_PATH];
+        ULONG len;
+
+        RtlUnicodeToUTF8N( module, sizeof(module) - 1, &len, ldr->BaseDllName.Buffer, ldr->BaseDllName.Length );
+        module[len] = 0;
+        name = find_export_name( ldr->BaseAddress, func, &addr );
+        format_frame_name( buffer, sizeof(buffer), module, name, addr, ldr->BaseAddress, func );
+    }
+    else snprintf( buffer, sizeof(buffer), "[unknown]+0x%lx", (unsigned long)(ULONG_PTR)func );
+
+    if ((ret = RtlAllocateHeap( GetProcessHeap(), 0, strlen( buffer ) + 1 ))) strcpy( ret, buffer );
+    return ret;
+}
+
+/* replace the frames of the samples by their function start, and return the
+ * names of the functions, sorted by start address */
+static struct frame_info *resolve_frames( int total, int *count )
+{
+    struct frame_info *frames = NULL, key, *frame;
+    void **pcs;
+    int pos, depth, i, nb_pcs = 0;
+
+    if (!(pcs = RtlAllocateHeap( GetProcessHeap(), 0, total * sizeof(*pcs) ))) return NULL;
+    for (pos = 0; pos < total && (depth = get_sample_depth( pos, total )); pos += depth + 1)
+    {
+        /* callers are return addresses, which may be past the end of the calling function */
+        for (i = 2; i <= depth; i++) samples[pos + i] = (char *)samples[pos + i] - 1;
+        memcpy( pcs + nb_pcs, samples + pos + 1, depth * sizeof(*pcs) );
+        nb_pcs += depth;
+    }
+
+    qsort( pcs, nb_pcs, sizeof(*pcs), compare_pcs );
+    for (i = *count = 0; i < nb_pcs; i++) if (!i || pcs[i] != pcs[i - 1]) pcs[(*count)++] = pcs[i];
+    if (!(frames = RtlAllocateHeap( GetProcessHeap(), 0, *count * sizeof(*frames) ))) goto done;
+    for (i = 0; i < *count; i++)
+    {
+        frames[i].pc = pcs[i];
+        frames[i].func = get_function_start( pcs[i] );
+    }
+
+    /* frames are still sorted by pc */
+    for (pos = 0; pos < total && (depth = get_sample_depth( pos, total )); pos += depth + 1)
+    {
+        for (i = 1; i <= depth; i++)
+        {
+            key.pc = samples[pos + i];
+            frame = bsearch( &key, frames, *count, sizeof(*frames), compare_frame_pcs );
+            samples[pos + i] = frame->func;
+        }
+    }
+
+    qsort( frames, *count, sizeof(*frames), compare_frame_funcs );
+    for (i = nb_pcs = 0; i < *count; i++)
+    {
+        if (i && frames[i].func == frames[i - 1].func) continue;
+        frames[nb_pcs].func = frames[i].func;
+        frames[nb_pcs++].name = get_frame_name( frames[i].func );
+    }
+    *count = nb_pcs;
+
+done:
+    RtlFreeHeap( GetProcessHeap(), 0, pcs );
+    return frames;
+}
+
+/***********************************************************************
+ *           profile_write
+ *
+ * Stop sampling and write out the collected samples. Called on process
+ * exit, with the other threads already terminated.
+ */
+void profile_write(void)
+{
+    struct frame_info *frames, key, *frame;
+    int i, j, pos, depth, total, nb_samples = 0, nb_frames = 0, *stacks = NULL;
+    unsigned int count;
+    FILE *file;
+
+    if (!samples) return;
+    profile_stop();
+
+    total = min( sample_words, MAX_SAMPLE_WORDS );
+    if (dropped_samples) WARN( "dropped %d samples\n", dropped_samples );
+
+    if (!(file = fopen( profile_path, "w" )))
+    {
+        ERR( "failed to open %s\n", debugstr_a(profile_path) );
+        samples = NULL;
+        return;
+    }
+
+    if (!(frames = resolve_frames( total, &nb_frames ))) goto done;
+    if (!(stacks = RtlAllocateHeap( GetProcessHeap(), 0, (total / 2 + 1) * sizeof(*stacks) ))) goto done;
+    for (pos = 0; pos < total && (depth = get_sample_depth( pos, total )); pos += depth + 1)
+        stacks[nb_samples++] = pos;
+    qsort( stacks, nb_samples, sizeof(*stacks), compare_stacks );
+
+    for (i = 0; i < nb_samples; i += count)
+    {
+        for (count = 1; i + count < nb_samples; count++)
+            if (compare_stacks( &stacks[i], &stacks[i + count] )) break;
+
+        /* the root of the stack comes first */
+        pos = stacks[i];
+        depth = (ULONG_PTR)samples[pos];
+        for (j = depth; j > 0; j--)
+        {
+            key.func = samples[pos + j];
+            frame = bsearch( &key, frames, nb_frames, sizeof(*frames), compare_frame_funcs );
+            fprintf( file, "%s%c", frame->name ? frame->name : "[unknown]", j > 1 ? ';' : ' ' );
+        }
+        fprintf( file, "%u\n", count );
+    }
+    TRACE( "wrote %d samples to %s\n", nb_samples, debugstr_a(profile_path) );
+
+done:
+    fclose( file );
+    if (frames)
+    {
+        for (i = 0; i < nb_frames; i++) RtlFreeHeap( GetProcessHeap(), 0, frames[i].name );
+        RtlFreeHeap( GetProcessHeap(), 0, frames );
+    }
+    RtlFreeHeap( GetProcessHeap(), 0, stacks );
+    samples = NULL;
+}
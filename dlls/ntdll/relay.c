@@ -26,6 +26,14 @@
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -34,6 +42,7 @@
 #include "wine/exception.h"
 #include "ntdll_misc.h"
 #include "wine/unicode.h"
+#include "wine/list.h"
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(relay);
@@ -328,6 +337,202 @@ static void trace_string_w( INT_PTR ptr )
     else TRACE( "%08lx", ptr );
 }
 
+/* binary relay log, enabled by setting WINERELAYLOG to the base name of the log files;
+ * every process writes to its own file, named after the base name and the process id
+ *
+ * Each thread gets its own chunk of the file mapped in memory and stores the records
+ * there directly, so no system call is made for a record and everything logged until
+ * the process crashes or gets killed ends up in the file. */
+
+#define RELAY_LOG_MAGIC        0x474c5257  /* "WRLG" */
+#define RELAY_LOG_VERSION      2
+#define RELAY_LOG_CHUNK_SIZE   0x10000     /* the header is alone in the first chunk */
+
+enum relay_log_type
+{
+    RELAY_LOG_MODULE,    /* module names: dll name then one name per entry point */
+    RELAY_LOG_CALL,      /* function call: return address then the argument words */
+    RELAY_LOG_RET        /* function return: return address then the return value */
+};
+
+struct relay_log_header
+{
+    DWORD magic;         /* RELAY_LOG_MAGIC */
+    DWORD version;       /* RELAY_LOG_VERSION */
+    DWORD ptr_size;      /* size of the data words */
+    DWORD freq;          /* timestamp frequency */
+    DWORD chunk_size;    /* RELAY_LOG_CHUNK_SIZE */
+};
+
+struct relay_log_chunk
+{
+    DWORD size;          /* size of the chunk, a multiple of RELAY_LOG_CHUNK_SIZE */
+    DWORD tid;           /* thread id */
+    DWORD pos;           /* end of the records stored so far */
+    DWORD pad;
+    /* followed by the records */
+};
+
+struct relay_log_record
+{
+    DWORD     size;      /* size of the record, including the data */
+    DWORD     type;      /* enum relay_log_type */
+    DWORD     tid;       /* thread id */
+    DWORD     ordinal;   /* entry point index, or ordinal base for module records */
+    ULONGLONG time;      /* timestamp */
+    ULONGLONG module;    /* module handle */
+    /* followed by the record data */
+};
+
+static int relay_log_fd = -1;
+static off_t relay_log_end;  /* end of the last chunk (relay_log_section) */
+static RTL_RUN_ONCE relay_log_once = RTL_RUN_ONCE_INIT;
+
+static RTL_CRITICAL_SECTION relay_log_section;
+static RTL_CRITICAL_SECTION_DEBUG relay_log_section_debug =
+{
+    0, 0, &relay_log_section,
+    { &relay_log_section_debug.ProcessLocksList, &relay_log_section_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": relay_log_section") }
+};
+static RTL_CRITICAL_SECTION relay_log_section = { &relay_log_section_debug, -1, 0, 0, 0, 0 };
+
+static DWORD WINAPI init_relay_log( RTL_RUN_ONCE *once, void *param, void **context )
+{
+    struct relay_log_header header;
+    LARGE_INTEGER counter, freq;
+    const char *name = getenv( "WINERELAYLOG" );
+    char *path;
+
+    if (!name || !*name) return TRUE;
+    if (!(path = RtlAllocateHeap( GetProcessHeap(), 0, strlen( name ) + 10 ))) return TRUE;
+    sprintf( path, "%s.%04x", name, GetCurrentProcessId() );
+    if ((relay_log_fd = open( path, O_RDWR | O_CREAT | O_TRUNC, 0666 )) == -1)
+        ERR( "failed to create relay log %s\n", debugstr_a(path) );
+    RtlFreeHeap( GetProcessHeap(), 0, path );
+    if (relay_log_fd == -1) return TRUE;
+
+    fcntl( relay_log_fd, F_SETFD, FD_CLOEXEC );
+
+    NtQueryPerformanceCounter( &counter, &freq );
+    header.magic      = RELAY_LOG_MAGIC;
+    header.version    = RELAY_LOG_VERSION;
+    header.ptr_size   = sizeof(ULONG_PTR);
+    header.freq       = freq.u.LowPart;
+    header.chunk_size = RELAY_LOG_CHUNK_SIZE;
+    write( relay_log_fd, &header, sizeof(header) );
+    relay_log_end = RELAY_LOG_CHUNK_SIZE;
+    return TRUE;
+}
+
+/* append a chunk large enough for size bytes of records to the file and map it */
+static struct relay_log_chunk *map_relay_log_chunk( unsigned int size )
+{
+    struct relay_log_chunk *chunk;
+
+    size = (sizeof(*chunk) + size + RELAY_LOG_CHUNK_SIZE - 1) & ~(RELAY_LOG_CHUNK_SIZE - 1);
+
+    RtlEnterCriticalSection( &relay_log_section );
+    if (ftruncate( relay_log_fd, relay_log_end + size ) == -1 ||
+        (chunk = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       relay_log_fd, relay_log_end )) == MAP_FAILED)
+        chunk = NULL;
+    else
+        relay_log_end += size;
+    RtlLeaveCriticalSection( &relay_log_section );
+
+    if (!chunk) return NULL;
+    chunk->size = size;
+    chunk->tid  = GetCurrentThreadId();
+    chunk->pos  = sizeof(*chunk);
+    return chunk;
+}
+
+/* reserve space for a record in the chunk of the current thread; no locking is needed
+ * except when a new chunk is mapped since the chunk is only accessed by its thread */
+static struct relay_log_record *alloc_relay_log_record( enum relay_log_type type,
+                                                        struct relay_private_data *data,
+                                                        unsigned int ordinal, unsigned int size )
+{
+    struct ntdll_thread_data *thread_data = ntdll_get_thread_data();
+    struct relay_log_chunk *chunk = thread_data->relay_log;
+    struct relay_log_record *record;
+    LARGE_INTEGER counter;
+
+    size += sizeof(*record);
+    if (!chunk || chunk->pos + size > chunk->size)
+    {
+        if (chunk) munmap( chunk, chunk->size );
+        thread_data->relay_log = chunk = map_relay_log_chunk( size );
+        if (!chunk) return NULL;
+    }
+
+    NtQueryPerformanceCounter( &counter, NULL );
+    record = (struct relay_log_record *)((char *)chunk + chunk->pos);
+    record->size    = size;
+    record->type    = type;
+    record->tid     = GetCurrentThreadId();
+    record->ordinal = ordinal;
+    record->time    = counter.QuadPart;
+    record->module  = (ULONG_PTR)data->module;
+    chunk->pos += size;
+    return record;
+}
+
+static void relay_log_call( struct relay_private_data *data, unsigned int ordinal,
+                            const ULONG_PTR *args, unsigned int nb_args, ULONG_PTR retaddr )
+{
+    struct relay_log_record *record;
+    ULONG_PTR *words;
+
+    if (!(record = alloc_relay_log_record( RELAY_LOG_CALL, data, ordinal,
+                                           (nb_args + 1) * sizeof(ULONG_PTR) )))
+        return;
+    words = (ULONG_PTR *)(record + 1);
+    words[0] = retaddr;
+    memcpy( words + 1, args, nb_args * sizeof(ULONG_PTR) );
+}
+
+static void relay_log_ret( struct relay_private_data *data, unsigned int ordinal,
+                           ULONG_PTR retaddr, ULONGLONG retval, BOOL is_int64 )
+{
+    struct relay_log_record *record;
+    unsigned int count = (sizeof(ULONG_PTR) < sizeof(ULONGLONG) && is_int64) ? 3 : 2;
+    ULONG_PTR *words;
+
+    if (!(record = alloc_relay_log_record( RELAY_LOG_RET, data, ordinal, count * sizeof(ULONG_PTR) )))
+        return;
+    words = (ULONG_PTR *)(record + 1);
+    words[0] = retaddr;
+    words[1] = (ULONG_PTR)retval;
+    if (count > 2) words[2] = (ULONG_PTR)(retval >> 32);
+}
+
+/* log the names of the entry points of a module, so that the log can be decoded offline */
+static void relay_log_module( struct relay_private_data *data, const IMAGE_EXPORT_DIRECTORY *exports )
+{
+    struct relay_log_record *record;
+    unsigned int i, size = strlen( data->dllname ) + 1;
+    char *p;
+
+    for (i = 0; i < exports->NumberOfFunctions; i++)
+        if (data->entry_points[i].name) size += strlen( data->entry_points[i].name );
+    size += exports->NumberOfFunctions;
+    size = (size + sizeof(ULONG_PTR) - 1) & ~(sizeof(ULONG_PTR) - 1);
+
+    /* the file is extended with zeros, so the padding is already cleared */
+    if (!(record = alloc_relay_log_record( RELAY_LOG_MODULE, data, data->base, size ))) return;
+
+    p = (char *)(record + 1);
+    strcpy( p, data->dllname );
+    p += strlen( p ) + 1;
+    for (i = 0; i < exports->NumberOfFunctions; i++)
+    {
+        if (data->entry_points[i].name) strcpy( p, data->entry_points[i].name );
+        p += strlen( p ) + 1;
+    }
+}
+
 #ifdef __i386__
 
 /***********************************************************************
@@ -377,6 +582,7 @@ DECLSPEC_HIDDEN void * WINAPI relay_trace_entry( struct relay_descr *descr, unsi
         if (!is_ret_val( arg_types[i+1] )) TRACE( "," );
     }
     *nb_args = pos;
+    if (relay_log_fd != -1) relay_log_call( data, ordinal, (const ULONG_PTR *)stack, pos, stack[-1] );
     if (arg_types[0] == 't')
     {
         *nb_args |= 0x80000000;  /* thiscall/fastcall */
@@ -397,6 +603,8 @@ DECLSPEC_HIDDEN void WINAPI relay_trace_exit( struct relay_descr *descr, unsigne
     TRACE( "\1Ret  %s()", func_name( descr->private, LOWORD(idx) ));
 
     while (!is_ret_val( *arg_types )) arg_types++;
+    if (relay_log_fd != -1)
+        relay_log_ret( descr->private, LOWORD(idx), (ULONG_PTR)retaddr, retval, *arg_types == 'J' );
     if (*arg_types == 'J')  /* int64 return value */
         TRACE( " retval=%08x%08x ret=%08x\n",
                (UINT)(retval >> 32), (UINT)retval, (UINT)retaddr );
@@ -479,6 +687,7 @@ DECLSPEC_HIDDEN void * WINAPI relay_trace_entry( struct relay_descr *descr, unsi
     const char *arg_types = descr->args_string + HIWORD(idx);
     struct relay_private_data *data = descr->private;
     struct relay_entry_point *entry_point = data->entry_points + ordinal;
+    const DWORD *args = stack;
     unsigned int i, pos;
 #ifndef __SOFTFP__
     unsigned int float_pos = 0, double_pos = 0;
@@ -546,6 +755,8 @@ DECLSPEC_HIDDEN void * WINAPI relay_trace_entry( struct relay_descr *descr, unsi
     }
 #endif
     *nb_args = pos;
+    if (relay_log_fd != -1)
+        relay_log_call( data, ordinal, (const ULONG_PTR *)args, pos & ~0x80000000, stack[-1] );
     TRACE( ") ret=%08x\n", stack[-1] );
     return entry_point->orig_func;
 }
@@ -561,6 +772,8 @@ DECLSPEC_HIDDEN void WINAPI relay_trace_exit( struct relay_descr *descr, unsigne
     TRACE( "\1Ret  %s()", func_name( descr->private, LOWORD(idx) ));
 
     while (!is_ret_val( *arg_types )) arg_types++;
+    if (relay_log_fd != -1)
+        relay_log_ret( descr->private, LOWORD(idx), retaddr, retval, *arg_types == 'J' );
     if (*arg_types == 'J')  /* int64 return value */
         TRACE( " retval=%08x%08x ret=%08x\n",
                (UINT)(retval >> 32), (UINT)retval, retaddr );
@@ -654,6 +867,7 @@ DECLSPEC_HIDDEN void * WINAPI relay_trace_entry( struct relay_descr *descr, unsi
         if (!is_ret_val( arg_types[i + 1] )) TRACE( "," );
     }
     *nb_args = i;
+    if (relay_log_fd != -1) relay_log_call( data, ordinal, (const ULONG_PTR *)stack, i, stack[-1] );
     TRACE( ") ret=%08lx\n", stack[-1] );
     return entry_point->orig_func;
 }
@@ -664,6 +878,7 @@ DECLSPEC_HIDDEN void * WINAPI relay_trace_entry( struct relay_descr *descr, unsi
 DECLSPEC_HIDDEN void WINAPI relay_trace_exit( struct relay_descr *descr, unsigned int idx,
                                               INT_PTR retaddr, INT_PTR retval )
 {
+    if (relay_log_fd != -1) relay_log_ret( descr->private, LOWORD(idx), retaddr, retval, FALSE );
     TRACE( "\1Ret  %s() retval=%08lx ret=%08lx\n",
            func_name( descr->private, LOWORD(idx) ), retval, retaddr );
 }
@@ -760,6 +975,7 @@ DECLSPEC_HIDDEN void * WINAPI relay_trace_entry( struct relay_descr *descr, unsi
         if (!is_ret_val( arg_types[i+1] )) TRACE( "," );
     }
     *nb_args = i;
+    if (relay_log_fd != -1) relay_log_call( data, ordinal, (const ULONG_PTR *)stack, i, stack[-1] );
     TRACE( ") ret=%08lx\n", stack[-1] );
     return entry_point->orig_func;
 }
@@ -770,6 +986,7 @@ DECLSPEC_HIDDEN void * WINAPI relay_trace_entry( struct relay_descr *descr, unsi
 DECLSPEC_HIDDEN void WINAPI relay_trace_exit( struct relay_descr *descr, unsigned int idx,
                                               INT_PTR retaddr, INT_PTR retval )
 {
+    if (relay_log_fd != -1) relay_log_ret( descr->private, LOWORD(idx), retaddr, retval, FALSE );
     TRACE( "\1Ret  %s() retval=%08lx ret=%08lx\n",
            func_name( descr->private, LOWORD(idx) ), retval, retaddr );
 }
@@ -952,6 +1169,36 @@ void RELAY_SetupDLL( HMODULE module )
     }
     if (old_prot != PAGE_READWRITE)
         NtProtectVirtualMemory( NtCurrentProcess(), &func_base, &func_size, old_prot, &old_prot );
+
+    if (relay_log_fd != -1) relay_log_module( data, exports );
+}
+
+
+/***********************************************************************
+ *           RELAY_IsEnabled
+ *
+ * Check whether relay debugging is enabled, either through the relay
+ * channel or through a binary relay log.
+ */
+BOOL RELAY_IsEnabled(void)
+{
+    RtlRunOnceExecuteOnce( &relay_log_once, init_relay_log, NULL, NULL );
+    return TRACE_ON(relay) || relay_log_fd != -1;
+}
+
+
+/***********************************************************************
+ *           RELAY_FreeThreadLog
+ *
+ * Unmap the binary relay log chunk of a thread that has exited.
+ */
+void RELAY_FreeThreadLog( TEB *teb )
+{
+    struct ntdll_thread_data *thread_data = (struct ntdll_thread_data *)&teb->GdiTebBatch;
+
+    if (!thread_data->relay_log) return;
+    munmap( thread_data->relay_log, thread_data->relay_log->size );
+    thread_data->relay_log = NULL;
 }
 
 #else  /* __i386__ || __x86_64__ || __arm__ || __aarch64__ */
@@ -966,6 +1213,15 @@ void RELAY_SetupDLL( HMODULE module )
 {
 }
 
+BOOL RELAY_IsEnabled(void)
+{
+    return TRACE_ON(relay);
+}
+
+void RELAY_FreeThreadLog( TEB *teb )
+{
+}
+
 #endif  /* __i386__ || __x86_64__ || __arm__ || __aarch64__ */
 
 
@@ -2229,6 +2229,24 @@ static void usr1_handler( int signal, siginfo_t *siginfo, void *sigcontext )
 }
 
 
+/**********************************************************************
+ *		prof_handler
+ *
+ * Handler for SIGPROF, used to record profiling samples.
+ */
+static void prof_handler( int signal, siginfo_t *siginfo, void *sigcontext )
+{
+    stack_t ss;
+
+    /* SIGPROF is sent to the process, it may be handled by a thread that has no TEB */
+    if (sigaltstack( NULL, &ss ) == -1 || !(ss.ss_flags & SS_ONSTACK))
+        profile_add_sample( NULL, (void *)EIP_sig( (ucontext_t *)sigcontext ), NULL );
+    else
+        profile_add_sample( get_current_teb(), (void *)EIP_sig( (ucontext_t *)sigcontext ),
+                            (void *)EBP_sig( (ucontext_t *)sigcontext ));
+}
+
+
 /***********************************************************************
  *           __wine_set_signal_handler   (NTDLL.@)
  */
@@ -2403,6 +2421,13 @@ void signal_init_process(void)
     if (sigaction( SIGTRAP, &sig_act, NULL ) == -1) goto error;
 #endif
 
+    if (profile_init())
+    {
+        sig_act.sa_sigaction = prof_handler;
+        if (sigaction( SIGPROF, &sig_act, NULL ) == -1) goto error;
+        profile_start();
+    }
+
     wine_ldt_init_locking( ldt_lock, ldt_unlock );
     return;
 
@@ -3095,6 +3095,24 @@ static void usr1_handler( int signal, siginfo_t *siginfo, void *ucontext )
 }
 
 
+/**********************************************************************
+ *		prof_handler
+ *
+ * Handler for SIGPROF, used to record profiling samples.
+ */
+static void prof_handler( int signal, siginfo_t *siginfo, void *ucontext )
+{
+    stack_t ss;
+
+    /* SIGPROF is sent to the process, it may be handled by a thread that has no TEB */
+    if (sigaltstack( NULL, &ss ) == -1 || !(ss.ss_flags & SS_ONSTACK))
+        profile_add_sample( NULL, (void *)RIP_sig( (ucontext_t *)ucontext ), NULL );
+    else
+        profile_add_sample( NtCurrentTeb(), (void *)RIP_sig( (ucontext_t *)ucontext ),
+                            (void *)RBP_sig( (ucontext_t *)ucontext ));
+}
+
+
 /***********************************************************************
  *           __wine_set_signal_handler   (NTDLL.@)
  */
@@ -3295,6 +3313,13 @@ void signal_init_process(void)
     sig_act.sa_sigaction = trap_handler;
     if (sigaction( SIGTRAP, &sig_act, NULL ) == -1) goto error;
 #endif
+
+    if (profile_init())
+    {
+        sig_act.sa_sigaction = prof_handler;
+        if (sigaction( SIGPROF, &sig_act, NULL ) == -1) goto error;
+        profile_start();
+    }
     return;
 
  error:
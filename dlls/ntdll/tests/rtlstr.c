@@ -2590,6 +2590,143 @@ static void test_RtlUTF8ToUnicodeN(void)
     }
 }
 
+struct utf8_run_test
+{
+    const char *utf8;
+    WCHAR unicode[3];
+    NTSTATUS status;
+};
+
+/* sequences placed between two runs of ASCII characters */
+static const struct utf8_run_test utf8_run_pieces[] =
+{
+    { "\xC3\xA9", { 0xe9,0 }, STATUS_SUCCESS },
+    { "\xE2\x82\xAC", { 0x20ac,0 }, STATUS_SUCCESS },
+    { "\xF0\x90\x80\x80", { 0xd800,0xdc00,0 }, STATUS_SUCCESS },
+    { "\x80", { 0xfffd,0 }, STATUS_SOME_NOT_MAPPED },
+    { "\xFF", { 0xfffd,0 }, STATUS_SOME_NOT_MAPPED },
+    { "\xE2\x82", { 0xfffd,0 }, STATUS_SOME_NOT_MAPPED },
+};
+
+static const struct utf8_run_test unicode_run_pieces[] =
+{
+    { "\xC3\xA9", { 0xe9,0 }, STATUS_SUCCESS },
+    { "\xDF\xBF", { 0x7ff,0 }, STATUS_SUCCESS },
+    { "\xE2\x82\xAC", { 0x20ac,0 }, STATUS_SUCCESS },
+    { "\xF0\x90\x80\x80", { 0xd800,0xdc00,0 }, STATUS_SUCCESS },
+    { "\xEF\xBF\xBD", { 0xd800,0 }, STATUS_SOME_NOT_MAPPED },
+    { "\xEF\xBF\xBD", { 0xdc00,0 }, STATUS_SOME_NOT_MAPPED },
+};
+
+/* The ASCII runs are converted several characters at a time, check that the
+ * end of a run is found wherever it falls, with any input alignment, and
+ * whether the following sequence is valid, invalid or truncated. */
+static void test_utf8_ascii_runs(void)
+{
+    unsigned int i, j, align, prefix, suffix, piece_len, in_len, out_len, len, expect_len;
+    char in_utf8[40], out_utf8[40], expect_utf8[40];
+    WCHAR in_unicode[40], out_unicode[40], expect_unicode[40];
+    const char *utf8;
+    const WCHAR *unicode;
+    NTSTATUS status;
+    ULONG bytes_out;
+
+    if (!pRtlUTF8ToUnicodeN || !pRtlUnicodeToUTF8N)
+    {
+        skip("RtlUTF8ToUnicodeN or RtlUnicodeToUTF8N unavailable\n");
+        return;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(utf8_run_pieces); i++)
+    for (align = 0; align < 4; align++)
+    for (prefix = 0; prefix < 10; prefix++)
+    for (suffix = 0; suffix < 10; suffix++)
+    {
+        utf8 = in_utf8 + align;
+        piece_len = strlen(utf8_run_pieces[i].utf8);
+        out_len = lstrlenW(utf8_run_pieces[i].unicode);
+        for (j = 0; j < prefix; j++) in_utf8[align + j] = expect_unicode[j] = 'a' + j;
+        memcpy(in_utf8 + align + prefix, utf8_run_pieces[i].utf8, piece_len);
+        memcpy(expect_unicode + prefix, utf8_run_pieces[i].unicode, out_len * sizeof(WCHAR));
+        for (j = 0; j < suffix; j++)
+            in_utf8[align + prefix + piece_len + j] = expect_unicode[prefix + out_len + j] = 'A' + j;
+        in_len = prefix + piece_len + suffix;
+        out_len += prefix + suffix;
+
+        bytes_out = 0x55555555;
+        status = pRtlUTF8ToUnicodeN(NULL, 0, &bytes_out, utf8, in_len);
+        ok(status == utf8_run_pieces[i].status && bytes_out == out_len * sizeof(WCHAR),
+           "(test %u, align %u, %u + %u): got status 0x%x, bytes_out %u\n",
+           i, align, prefix, suffix, status, bytes_out);
+
+        bytes_out = 0x55555555;
+        memset(out_unicode, 0x55, sizeof(out_unicode));
+        status = pRtlUTF8ToUnicodeN(out_unicode, sizeof(out_unicode), &bytes_out, utf8, in_len);
+        ok(status == utf8_run_pieces[i].status && bytes_out == out_len * sizeof(WCHAR) &&
+           !memcmp(out_unicode, expect_unicode, bytes_out) && out_unicode[out_len] == 0x5555,
+           "(test %u, align %u, %u + %u): got status 0x%x, %s\n",
+           i, align, prefix, suffix, status, wine_dbgstr_wn(out_unicode, bytes_out / sizeof(WCHAR)));
+
+        /* truncated output, leaving the surrogate pair case aside */
+        for (len = 0; len < out_len; len++)
+        {
+            if (utf8_run_pieces[i].unicode[1] && len == prefix + 1) continue;
+            bytes_out = 0x55555555;
+            memset(out_unicode, 0x55, sizeof(out_unicode));
+            status = pRtlUTF8ToUnicodeN(out_unicode, len * sizeof(WCHAR), &bytes_out, utf8, in_len);
+            ok(status == STATUS_BUFFER_TOO_SMALL && bytes_out == len * sizeof(WCHAR) &&
+               !memcmp(out_unicode, expect_unicode, bytes_out) && out_unicode[len] == 0x5555,
+               "(test %u, align %u, %u + %u, buffer %u): got status 0x%x, %s\n",
+               i, align, prefix, suffix, len, status, wine_dbgstr_wn(out_unicode, bytes_out / sizeof(WCHAR)));
+        }
+    }
+
+    for (i = 0; i < ARRAY_SIZE(unicode_run_pieces); i++)
+    for (align = 0; align < 4; align++)
+    for (prefix = 0; prefix < 10; prefix++)
+    for (suffix = 0; suffix < 10; suffix++)
+    {
+        unicode = in_unicode + align;
+        piece_len = lstrlenW(unicode_run_pieces[i].unicode);
+        out_len = strlen(unicode_run_pieces[i].utf8);
+        for (j = 0; j < prefix; j++) in_unicode[align + j] = expect_utf8[j] = 'a' + j;
+        memcpy(in_unicode + align + prefix, unicode_run_pieces[i].unicode, piece_len * sizeof(WCHAR));
+        memcpy(expect_utf8 + prefix, unicode_run_pieces[i].utf8, out_len);
+        for (j = 0; j < suffix; j++)
+            in_unicode[align + prefix + piece_len + j] = expect_utf8[prefix + out_len + j] = 'A' + j;
+        in_len = prefix + piece_len + suffix;
+        piece_len = out_len;
+        out_len += prefix + suffix;
+
+        bytes_out = 0x55555555;
+        status = pRtlUnicodeToUTF8N(NULL, 0, &bytes_out, unicode, in_len * sizeof(WCHAR));
+        ok(status == unicode_run_pieces[i].status && bytes_out == out_len,
+           "(test %u, align %u, %u + %u): got status 0x%x, bytes_out %u\n",
+           i, align, prefix, suffix, status, bytes_out);
+
+        bytes_out = 0x55555555;
+        memset(out_utf8, 0x55, sizeof(out_utf8));
+        status = pRtlUnicodeToUTF8N(out_utf8, sizeof(out_utf8), &bytes_out, unicode, in_len * sizeof(WCHAR));
+        ok(status == unicode_run_pieces[i].status && bytes_out == out_len &&
+           !memcmp(out_utf8, expect_utf8, bytes_out) && out_utf8[out_len] == 0x55,
+           "(test %u, align %u, %u + %u): got status 0x%x, %s\n",
+           i, align, prefix, suffix, status, wine_dbgstr_an(out_utf8, bytes_out));
+
+        /* truncated output, a multi-byte sequence is either written whole or not at all */
+        for (len = 0; len < out_len; len++)
+        {
+            expect_len = (len > prefix && len < prefix + piece_len) ? prefix : len;
+            bytes_out = 0x55555555;
+            memset(out_utf8, 0x55, sizeof(out_utf8));
+            status = pRtlUnicodeToUTF8N(out_utf8, len, &bytes_out, unicode, in_len * sizeof(WCHAR));
+            ok(status == STATUS_BUFFER_TOO_SMALL && bytes_out == expect_len &&
+               !memcmp(out_utf8, expect_utf8, bytes_out) && out_utf8[expect_len] == 0x55,
+               "(test %u, align %u, %u + %u, buffer %u): got status 0x%x, %s\n",
+               i, align, prefix, suffix, len, status, wine_dbgstr_an(out_utf8, bytes_out));
+        }
+    }
+}
+
 START_TEST(rtlstr)
 {
     InitFunctionPtrs();
@@ -2626,4 +2763,5 @@ START_TEST(rtlstr)
     test_RtlHashUnicodeString();
     test_RtlUnicodeToUTF8N();
     test_RtlUTF8ToUnicodeN();
+    test_utf8_ascii_runs();
 }
@@ -371,6 +371,7 @@ static void free_thread_data( TEB *teb )
         size = 0;
         NtFreeVirtualMemory( GetCurrentProcess(), &thread_data->start_stack, &size, MEM_RELEASE );
     }
+    RELAY_FreeThreadLog( teb );
     signal_free_thread( teb );
 }
 
@@ -381,7 +382,12 @@ static void free_thread_data( TEB *teb )
 void abort_thread( int status )
 {
     pthread_sigmask( SIG_BLOCK, &server_block_set, NULL );
-    if (interlocked_xchg_add( &nb_threads, -1 ) <= 1) _exit( get_unix_exit_code( status ));
+    if (interlocked_xchg_add( &nb_threads, -1 ) <= 1)
+    {
+        profile_abort();
+        debug_flush( 50 );
+        _exit( get_unix_exit_code( status ));
+    }
     signal_exit_thread( status );
 }
 
@@ -420,7 +426,9 @@ void WINAPI RtlExitUserThread( ULONG status )
 
     if (interlocked_xchg_add( &nb_threads, -1 ) <= 1)
     {
+        profile_write();
         LdrShutdownProcess();
+        debug_flush( 1000 );
         pthread_sigmask( SIG_BLOCK, &server_block_set, NULL );
         signal_exit_process( get_unix_exit_code( status ));
     }
@@ -458,6 +466,7 @@ static void start_thread( struct startup_info *info )
     struct debug_info debug_info;
 
     debug_info.str_pos = debug_info.out_pos = 0;
+    debug_info.unix_tid = 0;
     thread_data->debug_info = &debug_info;
     thread_data->pthread_id = pthread_self();
 
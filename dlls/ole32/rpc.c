@@ -70,6 +70,19 @@ static CRITICAL_SECTION_DEBUG csChannelHook_debug =
 };
 static CRITICAL_SECTION csChannelHook = { &csChannelHook_debug, -1, 0, 0, 0, 0 };
 
+/* calls waiting for an MTA worker thread (CS csMtaCalls) */
+static struct list mta_calls = LIST_INIT(mta_calls);
+static unsigned int mta_idle_workers;
+static HANDLE mta_call_semaphore;
+static CRITICAL_SECTION csMtaCalls;
+static CRITICAL_SECTION_DEBUG csMtaCalls_debug =
+{
+    0, 0, &csMtaCalls,
+    { &csMtaCalls_debug.ProcessLocksList, &csMtaCalls_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": mta calls") }
+};
+static CRITICAL_SECTION csMtaCalls = { &csMtaCalls_debug, -1, 0, 0, 0, 0 };
+
 static WCHAR wszRpcTransport[] = {'n','c','a','l','r','p','c',0};
 
 
@@ -119,6 +132,7 @@ struct dispatch_params
     BOOL               bypass_rpcrt; /* bypass RPC runtime? */
     RPC_STATUS         status; /* status (out) */
     HRESULT            hr; /* hresult (out) */
+    struct list        entry; /* entry in mta_calls, if applicable */
 };
 
 struct message_state
@@ -685,24 +699,18 @@ static HRESULT WINAPI ClientRpcChannelBuffer_GetBuffer(LPRPCCHANNELBUFFER iface,
                                   &message_state->params.iface);
     if (hr == S_OK)
     {
-        /* stub, chan, iface and iid are unneeded in multi-threaded case as we go
-         * via the RPC runtime */
+        /* the object lives in this process, so call it directly instead of
+         * going through the RPC runtime: STAs get the call through their
+         * apartment window and MTAs on a worker thread that joins the MTA */
         if (apt->multi_threaded)
-        {
-            IRpcStubBuffer_Release(message_state->params.stub);
-            message_state->params.stub = NULL;
-            IRpcChannelBuffer_Release(message_state->params.chan);
-            message_state->params.chan = NULL;
-            message_state->params.iface = NULL;
-        }
+            message_state->params.bypass_rpcrt = TRUE;
         else
         {
-            message_state->params.bypass_rpcrt = TRUE;
             message_state->target_hwnd = apartment_getwindow(apt);
             message_state->target_tid = apt->tid;
-            /* we assume later on that this being non-NULL is the indicator that
-             * means call directly instead of going through RPC runtime */
-            if (!message_state->target_hwnd)
+            if (message_state->target_hwnd)
+                message_state->params.bypass_rpcrt = TRUE;
+            else
                 ERR("window for apartment %s is NULL\n", wine_dbgstr_longlong(apt->oxid));
         }
     }
@@ -712,7 +720,7 @@ static HRESULT WINAPI ClientRpcChannelBuffer_GetBuffer(LPRPCCHANNELBUFFER iface,
      * ClientRpcChannelBuffer_SendReceive */
 
     /* shortcut the RPC runtime */
-    if (message_state->target_hwnd)
+    if (message_state->params.bypass_rpcrt)
     {
         msg->Buffer = HeapAlloc(GetProcessHeap(), 0, msg->BufferLength);
         if (msg->Buffer)
@@ -803,6 +811,82 @@ static DWORD WINAPI rpc_sendreceive_thread(LPVOID param)
     return 0;
 }
 
+/* these threads run outgoing calls to the MTA of this process. They are our
+ * own threads rather than thread pool ones, since the application may leave
+ * a pool thread in an STA. */
+static DWORD WINAPI rpc_mta_worker_thread(LPVOID param)
+{
+    struct oletls *info = COM_CurrentInfo();
+    struct dispatch_params *params;
+
+    for (;;)
+    {
+        if (WaitForSingleObject(mta_call_semaphore, 30000))
+        {
+            /* a call may have been queued for us since the wait timed out */
+            EnterCriticalSection(&csMtaCalls);
+            if (WaitForSingleObject(mta_call_semaphore, 0))
+            {
+                mta_idle_workers--;
+                LeaveCriticalSection(&csMtaCalls);
+                return 0;
+            }
+            LeaveCriticalSection(&csMtaCalls);
+        }
+
+        EnterCriticalSection(&csMtaCalls);
+        params = LIST_ENTRY(list_head(&mta_calls), struct dispatch_params, entry);
+        list_remove(&params->entry);
+        LeaveCriticalSection(&csMtaCalls);
+
+        enter_apartment(info, COINIT_MULTITHREADED);
+        RPC_ExecuteCall(params);
+        leave_apartment(info);
+
+        EnterCriticalSection(&csMtaCalls);
+        mta_idle_workers++;
+        LeaveCriticalSection(&csMtaCalls);
+    }
+}
+
+/* hands a call over to an idle MTA worker, starting a new one if they are
+ * all busy, so that calls made back into the MTA while running another one
+ * don't have to wait for it */
+static HRESULT rpc_queue_mta_call(struct dispatch_params *params)
+{
+    HRESULT hr = S_OK;
+    HANDLE thread;
+
+    EnterCriticalSection(&csMtaCalls);
+    if (!mta_call_semaphore && !(mta_call_semaphore = CreateSemaphoreW(NULL, 0, MAXLONG, NULL)))
+    {
+        ERR("CreateSemaphore failed with error %u\n", GetLastError());
+        hr = HRESULT_FROM_WIN32(GetLastError());
+    }
+    else if (!mta_idle_workers)
+    {
+        if ((thread = CreateThread(NULL, 0, rpc_mta_worker_thread, NULL, 0, NULL)))
+        {
+            CloseHandle(thread);
+            mta_idle_workers++;
+        }
+        else
+        {
+            ERR("CreateThread failed with error %u\n", GetLastError());
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+    }
+    if (hr == S_OK)
+    {
+        mta_idle_workers--;
+        list_add_tail(&mta_calls, &params->entry);
+        ReleaseSemaphore(mta_call_semaphore, 1, NULL);
+    }
+    LeaveCriticalSection(&csMtaCalls);
+
+    return hr;
+}
+
 static inline HRESULT ClientRpcChannelBuffer_IsCorrectApartment(ClientRpcChannelBuffer *This, APARTMENT *apt)
 {
     OXID oxid;
@@ -867,7 +951,7 @@ static HRESULT WINAPI ClientRpcChannelBuffer_SendReceive(LPRPCCHANNELBUFFER ifac
      * from DllMain */
 
     message_state->params.msg = olemsg;
-    if (message_state->params.bypass_rpcrt)
+    if (message_state->params.bypass_rpcrt && message_state->target_hwnd)
     {
         TRACE("Calling apartment thread 0x%08x...\n", message_state->target_tid);
 
@@ -884,6 +968,16 @@ static HRESULT WINAPI ClientRpcChannelBuffer_SendReceive(LPRPCCHANNELBUFFER ifac
             hr = HRESULT_FROM_WIN32(GetLastError());
         }
     }
+    else if (message_state->params.bypass_rpcrt)
+    {
+        TRACE("Calling multi-threaded apartment...\n");
+
+        msg->ProcNum &= ~RPC_FLAGS_VALID_BIT;
+
+        /* as below, the calling thread must keep pumping messages while the
+         * call is executed */
+        hr = rpc_queue_mta_call(&message_state->params);
+    }
     else
     {
         /* we use a separate thread here because we need to be able to
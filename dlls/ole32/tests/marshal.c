@@ -1284,6 +1284,99 @@ static void test_marshal_proxy_mta_apartment_shutdown(void)
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
 }
 
+static HRESULT WINAPI MTA_IClassFactory_LockServer(IClassFactory *iface, BOOL lock)
+{
+    APTTYPEQUALIFIER qualifier;
+    APTTYPE type;
+    HRESULT hr;
+
+    hr = CoGetApartmentType(&type, &qualifier);
+    ok(hr == S_OK, "CoGetApartmentType failed: %08x\n", hr);
+    ok(type == APTTYPE_MTA, "got apartment type %d\n", type);
+    return S_OK;
+}
+
+static const IClassFactoryVtbl MTAClassFactory_Vtbl =
+{
+    Test_IClassFactory_QueryInterface,
+    Test_IClassFactory_AddRef,
+    Test_IClassFactory_Release,
+    Test_IClassFactory_CreateInstance,
+    MTA_IClassFactory_LockServer
+};
+
+static IClassFactory MTA_ClassFactory = { &MTAClassFactory_Vtbl };
+
+struct mta_host_data
+{
+    IStream *stream;
+    HANDLE marshal_event;
+    HANDLE done_event;
+};
+
+static DWORD CALLBACK mta_host_object_proc(void *p)
+{
+    struct mta_host_data *data = p;
+    HRESULT hr;
+
+    CoInitializeEx(NULL, COINIT_MULTITHREADED);
+
+    hr = CoMarshalInterface(data->stream, &IID_IClassFactory, (IUnknown *)&MTA_ClassFactory,
+                            MSHCTX_INPROC, NULL, MSHLFLAGS_NORMAL);
+    ok_ole_success(hr, CoMarshalInterface);
+
+    SetEvent(data->marshal_event);
+    ok( !WaitForSingleObject(data->done_event, 10000), "wait timed out\n" );
+
+    CoUninitialize();
+    return 0;
+}
+
+/* tests calls from an STA to an object living in the MTA of the same process */
+static void test_marshal_mta_object_from_sta(void)
+{
+    struct mta_host_data data;
+    IClassFactory *proxy;
+    HANDLE thread;
+    HRESULT hr;
+    int i;
+
+    cLocks = 0;
+    external_connections = 0;
+
+    hr = CreateStreamOnHGlobal(NULL, TRUE, &data.stream);
+    ok_ole_success(hr, CreateStreamOnHGlobal);
+    data.marshal_event = CreateEventA(NULL, FALSE, FALSE, NULL);
+    data.done_event = CreateEventA(NULL, FALSE, FALSE, NULL);
+    thread = CreateThread(NULL, 0, mta_host_object_proc, &data, 0, NULL);
+    ok( !WaitForSingleObject(data.marshal_event, 10000), "wait timed out\n" );
+
+    ok_more_than_one_lock();
+
+    IStream_Seek(data.stream, ullZero, STREAM_SEEK_SET, NULL);
+    hr = CoUnmarshalInterface(data.stream, &IID_IClassFactory, (void **)&proxy);
+    ok_ole_success(hr, CoUnmarshalInterface);
+    IStream_Release(data.stream);
+
+    for (i = 0; i < 10; i++)
+    {
+        hr = IClassFactory_LockServer(proxy, TRUE);
+        ok_ole_success(hr, IClassFactory_LockServer);
+        hr = IClassFactory_LockServer(proxy, FALSE);
+        ok_ole_success(hr, IClassFactory_LockServer);
+    }
+
+    IClassFactory_Release(proxy);
+
+    ok_no_locks();
+
+    SetEvent(data.done_event);
+    ok( !WaitForSingleObject(thread, 10000), "wait timed out\n" );
+    CloseHandle(thread);
+    CloseHandle(data.marshal_event);
+    CloseHandle(data.done_event);
+}
+
 static void test_marshal_channel_buffer(void)
 {
     DWORD registration_key;
@@ -4509,6 +4602,7 @@ START_TEST(marshal)
         test_marshal_stub_apartment_shutdown();
         test_marshal_proxy_apartment_shutdown();
         test_marshal_proxy_mta_apartment_shutdown();
+        test_marshal_mta_object_from_sta();
         test_no_couninitialize_server();
         test_no_couninitialize_client();
         test_tableweak_marshal_and_unmarshal_twice();
@@ -6452,6 +6452,39 @@ HRESULT WINAPI VarBstrFromI4(LONG lIn, LCID lcid, ULONG dwFlags, BSTR* pbstrOut)
   return VARIANT_BstrFromUInt(ul64, lcid, dwFlags, pbstrOut);
 }
 
+static CRITICAL_SECTION decimal_sep_cs;
+static CRITICAL_SECTION_DEBUG decimal_sep_cs_debug =
+{
+    0, 0, &decimal_sep_cs,
+    { &decimal_sep_cs_debug.ProcessLocksList, &decimal_sep_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": decimal_sep_cs") }
+};
+static CRITICAL_SECTION decimal_sep_cs = { &decimal_sep_cs_debug, -1, 0, 0, 0, 0 };
+
+/* Get the decimal separator for an lcid. Like the number characters used for
+ * parsing, the last one looked up is cached, since every real to string
+ * conversion needs it and GetLocaleInfoW() is expensive for default locales. */
+static void VARIANT_GetLocalisedDecimalSep(WCHAR *lpDecimalSep, int len, LCID lcid, ULONG dwFlags)
+{
+  static WCHAR lastSep[16];
+  static LCID lastLcid = -1;
+  static ULONG lastFlags = 0;
+  ULONG flags = dwFlags & LOCALE_NOUSEROVERRIDE;
+
+  EnterCriticalSection(&decimal_sep_cs);
+
+  if (lcid != lastLcid || flags != lastFlags)
+  {
+    lastSep[0] = '\0';
+    GetLocaleInfoW(lcid, LOCALE_SDECIMAL | flags, lastSep, ARRAY_SIZE(lastSep));
+    lastLcid = lcid;
+    lastFlags = flags;
+  }
+  lstrcpynW(lpDecimalSep, lastSep, len);
+
+  LeaveCriticalSection(&decimal_sep_cs);
+}
+
 static BSTR VARIANT_BstrReplaceDecimal(const WCHAR * buff, LCID lcid, ULONG dwFlags)
 {
   BSTR bstrOut;
@@ -6464,8 +6497,7 @@ static BSTR VARIANT_BstrReplaceDecimal(const WCHAR * buff, LCID lcid, ULONG dwFl
      the need to replace the decimal separator, and if so, will prepare an
      appropriate NUMBERFMTW structure to do the job via GetNumberFormatW().
    */
-  GetLocaleInfoW(lcid, LOCALE_SDECIMAL | (dwFlags & LOCALE_NOUSEROVERRIDE),
-                 lpDecimalSep, ARRAY_SIZE(lpDecimalSep));
+  VARIANT_GetLocalisedDecimalSep(lpDecimalSep, ARRAY_SIZE(lpDecimalSep), lcid, dwFlags);
   if (lpDecimalSep[0] == '.' && lpDecimalSep[1] == '\0')
   {
     /* locale is compatible with English - return original string */
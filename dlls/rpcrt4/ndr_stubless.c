@@ -535,6 +535,41 @@ void client_do_args( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat, enum s
     }
 }
 
+/* -Oicf procedure headers carry the precomputed buffer space needed by all
+ * the parameters that don't have the MustSize attribute, so only the remaining
+ * ones need to go through the buffer sizing routines. */
+static void client_calc_size( PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat,
+                              unsigned short number_of_params, unsigned short constant_size )
+{
+    const NDR_PARAM_OIF *params = (const NDR_PARAM_OIF *)pFormat;
+    unsigned int i;
+
+    pStubMsg->BufferLength = constant_size;
+
+    for (i = 0; i < number_of_params; i++)
+    {
+        unsigned char *pArg = pStubMsg->StackTop + params[i].stack_offset;
+
+        if (params[i].attr.IsSimpleRef && !*(unsigned char **)pArg)
+            RpcRaiseException(RPC_X_NULL_REF_POINTER);
+        if (params[i].attr.IsIn && params[i].attr.MustSize)
+        {
+            TRACE("param[%d]: %p must size\n", i, pArg);
+            call_buffer_sizer(pStubMsg, pArg, &params[i]);
+        }
+    }
+}
+
+/* widl passes explicit primitive handles as FC_LONG parameters with a
+ * precomputed buffer size, but leaves them out of constant_client_buffer_size,
+ * so those procedures have to size all their parameters. */
+static BOOL client_has_explicit_primitive_handle( const NDR_PROC_HEADER *proc_header,
+                                                  PFORMAT_STRING handle_format )
+{
+    if (proc_header->Oi_flags & Oi_OBJECT_PROC) return FALSE;
+    return !proc_header->handle_type && *handle_format == FC_BIND_PRIMITIVE;
+}
+
 static unsigned int type_stack_size(unsigned char fc)
 {
     switch (fc)
@@ -699,7 +734,8 @@ static void CALLBACK ndr_client_call_finally(BOOL normal, void *arg)
 static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORMAT_STRING format,
         const PFORMAT_STRING handle_format, void **stack_top, void **fpu_stack, MIDL_STUB_MESSAGE *stub_msg,
         unsigned short procedure_number, unsigned short stack_size, unsigned int number_of_params,
-        INTERPRETER_OPT_FLAGS Oif_flags, INTERPRETER_OPT_FLAGS2 ext_flags, const NDR_PROC_HEADER *proc_header )
+        INTERPRETER_OPT_FLAGS Oif_flags, INTERPRETER_OPT_FLAGS2 ext_flags, const NDR_PROC_HEADER *proc_header,
+        const NDR_PROC_PARTIAL_OIF_HEADER *oif_header )
 {
     struct ndr_client_call_ctx finally_ctx;
     RPC_MESSAGE rpc_msg;
@@ -789,8 +825,11 @@ static LONG_PTR do_ndr_client_call( const MIDL_STUB_DESC *stub_desc, const PFORM
 
         /* 2. CALCSIZE */
         TRACE( "CALCSIZE\n" );
-        client_do_args(stub_msg, format, STUBLESS_CALCSIZE, fpu_stack,
-                       number_of_params, (unsigned char *)&retval);
+        if (oif_header && !client_has_explicit_primitive_handle(proc_header, handle_format))
+            client_calc_size(stub_msg, format, number_of_params, oif_header->constant_client_buffer_size);
+        else
+            client_do_args(stub_msg, format, STUBLESS_CALCSIZE, fpu_stack,
+                           number_of_params, (unsigned char *)&retval);
 
         /* 3. GETBUFFER */
         TRACE( "GETBUFFER\n" );
@@ -863,6 +902,8 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
     /* the value to return to the client from the remote procedure */
     LONG_PTR RetVal = 0;
     PFORMAT_STRING pHandleFormat;
+    /* -Oicf header, NULL for old style format strings */
+    const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader = NULL;
     NDR_PARAM_OIF old_args[256];
 
     TRACE("pStubDesc %p, pFormat %p, ...\n", pStubDesc, pFormat);
@@ -895,8 +936,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
 
     if (is_oicf_stubdesc(pStubDesc))  /* -Oicf format */
     {
-        const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader =
-            (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
+        pOIFHeader = (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
 
         Oif_flags = pOIFHeader->Oi2Flags;
         number_of_params = pOIFHeader->number_of_params;
@@ -938,7 +978,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
         {
             RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                     stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                    number_of_params, Oif_flags, ext_flags, pProcHeader);
+                    number_of_params, Oif_flags, ext_flags, pProcHeader, pOIFHeader);
         }
         __EXCEPT_ALL
         {
@@ -956,7 +996,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
         {
             RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                     stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                    number_of_params, Oif_flags, ext_flags, pProcHeader);
+                    number_of_params, Oif_flags, ext_flags, pProcHeader, pOIFHeader);
         }
         __EXCEPT_ALL
         {
@@ -989,7 +1029,7 @@ LONG_PTR CDECL DECLSPEC_HIDDEN ndr_client_call( PMIDL_STUB_DESC pStubDesc, PFORM
     {
         RetVal = do_ndr_client_call(pStubDesc, pFormat, pHandleFormat,
                 stack_top, fpu_stack, &stubMsg, procedure_number, stack_size,
-                number_of_params, Oif_flags, ext_flags, pProcHeader);
+                number_of_params, Oif_flags, ext_flags, pProcHeader, pOIFHeader);
     }
 
     TRACE("RetVal = 0x%lx\n", RetVal);
@@ -1289,6 +1329,27 @@ static LONG_PTR *stub_do_args(MIDL_STUB_MESSAGE *pStubMsg,
     return retval_ptr;
 }
 
+/* see client_calc_size() */
+static void stub_calc_size(MIDL_STUB_MESSAGE *pStubMsg, PFORMAT_STRING pFormat,
+                           unsigned short number_of_params, unsigned short constant_size)
+{
+    const NDR_PARAM_OIF *params = (const NDR_PARAM_OIF *)pFormat;
+    unsigned int i;
+
+    pStubMsg->BufferLength = constant_size;
+
+    for (i = 0; i < number_of_params; i++)
+    {
+        unsigned char *pArg = pStubMsg->StackTop + params[i].stack_offset;
+
+        if ((params[i].attr.IsOut || params[i].attr.IsReturn) && params[i].attr.MustSize)
+        {
+            TRACE("param[%d]: %p must size\n", i, pArg);
+            call_buffer_sizer(pStubMsg, pArg, &params[i]);
+        }
+    }
+}
+
 /***********************************************************************
  *            NdrStubCall2 [RPCRT4.@]
  *
@@ -1322,6 +1383,8 @@ LONG WINAPI NdrStubCall2(
     enum stubless_phase phase;
     /* header for procedure string */
     const NDR_PROC_HEADER *pProcHeader;
+    /* -Oicf header, NULL for old style format strings */
+    const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader = NULL;
     /* location to put retval into */
     LONG_PTR *retval_ptr = NULL;
     /* correlation cache */
@@ -1419,7 +1482,7 @@ LONG WINAPI NdrStubCall2(
 
     if (is_oicf_stubdesc(pStubDesc))
     {
-        const NDR_PROC_PARTIAL_OIF_HEADER *pOIFHeader = (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
+        pOIFHeader = (const NDR_PROC_PARTIAL_OIF_HEADER *)pFormat;
 
         Oif_flags = pOIFHeader->Oi2Flags;
         number_of_params = pOIFHeader->number_of_params;
@@ -1516,9 +1579,15 @@ LONG WINAPI NdrStubCall2(
                 stubMsg.Buffer = pRpcMsg->Buffer;
             }
             break;
+        case STUBLESS_CALCSIZE:
+            if (pOIFHeader)
+            {
+                stub_calc_size(&stubMsg, pFormat, number_of_params, pOIFHeader->constant_server_buffer_size);
+                break;
+            }
+            /* fall through */
         case STUBLESS_UNMARSHAL:
         case STUBLESS_INITOUT:
-        case STUBLESS_CALCSIZE:
         case STUBLESS_MARSHAL:
         case STUBLESS_MUSTFREE:
         case STUBLESS_FREE:
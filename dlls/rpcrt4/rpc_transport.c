@@ -468,6 +468,96 @@ static int rpcrt4_conn_np_wait_for_incoming_data(RpcConnection *conn)
     return rpcrt4_conn_np_read(conn, NULL, 0);
 }
 
+static RPC_STATUS rpcrt4_conn_np_receive_fragment(RpcConnection *conn, RpcPktHdr **Header, void **Payload)
+{
+    unsigned char buffer[RPC_MAX_PACKET_SIZE];
+    const RpcPktCommonHdr *common_hdr = (const RpcPktCommonHdr *)buffer;
+    RPC_STATUS status;
+    DWORD hdr_length;
+    int count, len;
+
+    *Header = NULL;
+    *Payload = NULL;
+
+    TRACE("(%p, %p, %p)\n", conn, Header, Payload);
+
+    /* Fragments are sent with a single write and our pipes are in message
+     * mode, so the whole fragment normally arrives with one read instead of
+     * separate round trips for the common header, the rest of the header and
+     * the body. */
+    count = rpcrt4_conn_np_read(conn, buffer, sizeof(buffer));
+    if (count < (int)sizeof(*common_hdr))
+    {
+        WARN("Short read of header, %d bytes\n", count);
+        return RPC_S_CALL_FAILED;
+    }
+
+    status = RPCRT4_ValidateCommonHeader(common_hdr);
+    if (status != RPC_S_OK) return status;
+
+    hdr_length = RPCRT4_GetHeaderSize((const RpcPktHdr *)common_hdr);
+    if (!hdr_length || common_hdr->frag_len < hdr_length || count > common_hdr->frag_len)
+    {
+        WARN("bad fragment, frag_len %d, hdr_length %d, read %d bytes\n",
+             common_hdr->frag_len, hdr_length, count);
+        return RPC_S_PROTOCOL_ERROR;
+    }
+
+    *Header = HeapAlloc(GetProcessHeap(), 0, hdr_length);
+    if (!*Header) return RPC_S_OUT_OF_RESOURCES;
+
+    if (common_hdr->frag_len - hdr_length)
+    {
+        *Payload = HeapAlloc(GetProcessHeap(), 0, common_hdr->frag_len - hdr_length);
+        if (!*Payload)
+        {
+            status = RPC_S_OUT_OF_RESOURCES;
+            goto fail;
+        }
+    }
+
+    if (count < hdr_length)
+    {
+        memcpy(*Header, buffer, count);
+        len = rpcrt4_conn_np_read(conn, (unsigned char *)*Header + count, hdr_length - count);
+        if (len != hdr_length - count)
+        {
+            WARN("bad header length, %d bytes, hdr_length %d\n", count + len, hdr_length);
+            status = RPC_S_CALL_FAILED;
+            goto fail;
+        }
+        count = hdr_length;
+    }
+    else
+    {
+        memcpy(*Header, buffer, hdr_length);
+        if (count > hdr_length) memcpy(*Payload, buffer + hdr_length, count - hdr_length);
+    }
+
+    /* the sender split the fragment, or it didn't fit in our buffer */
+    while (count < (*Header)->common.frag_len)
+    {
+        len = rpcrt4_conn_np_read(conn, (unsigned char *)*Payload + count - hdr_length,
+                                  (*Header)->common.frag_len - count);
+        if (len <= 0)
+        {
+            WARN("bad data length, %d/%d\n", count - hdr_length, (*Header)->common.frag_len - hdr_length);
+            status = RPC_S_CALL_FAILED;
+            goto fail;
+        }
+        count += len;
+    }
+
+    return RPC_S_OK;
+
+fail:
+    RPCRT4_FreeHeader(*Header);
+    *Header = NULL;
+    HeapFree(GetProcessHeap(), 0, *Payload);
+    *Payload = NULL;
+    return status;
+}
+
 static size_t rpcrt4_ncacn_np_get_top_of_tower(unsigned char *tower_data,
                                                const char *networkaddr,
                                                const char *endpoint)
@@ -3145,7 +3235,7 @@ static const struct connection_ops conn_protseq_list[] = {
     rpcrt4_conn_np_wait_for_incoming_data,
     rpcrt4_ncacn_np_get_top_of_tower,
     rpcrt4_ncacn_np_parse_top_of_tower,
-    NULL,
+    rpcrt4_conn_np_receive_fragment,
     RPCRT4_default_is_authorized,
     RPCRT4_default_authorize,
     RPCRT4_default_secure_packet,
@@ -3167,7 +3257,7 @@ static const struct connection_ops conn_protseq_list[] = {
     rpcrt4_conn_np_wait_for_incoming_data,
     rpcrt4_ncalrpc_get_top_of_tower,
     rpcrt4_ncalrpc_parse_top_of_tower,
-    NULL,
+    rpcrt4_conn_np_receive_fragment,
     rpcrt4_ncalrpc_is_authorized,
     rpcrt4_ncalrpc_authorize,
     rpcrt4_ncalrpc_secure_packet,
@@ -144,6 +144,7 @@ static int (__cdecl *sum_array_ptr)(int (*a)[2]);
 static ctx_handle_t __cdecl (*get_handle)(void);
 static void (__cdecl *get_handle_by_ptr)(ctx_handle_t *r);
 static void (__cdecl *test_handle)(ctx_handle_t ctx_handle);
+static int (__cdecl *explicit_handle_return)(handle_t binding);
 
 #define SERVER_FUNCTIONS \
     X(int_return) \
@@ -234,7 +235,8 @@ static void (__cdecl *test_handle)(ctx_handle_t ctx_handle);
     X(sum_array_ptr) \
     X(get_handle) \
     X(get_handle_by_ptr) \
-    X(test_handle)
+    X(test_handle) \
+    X(explicit_handle_return)
 
 /* type check statements generated in header file */
 fnprintf *p_printf = printf;
@@ -1089,6 +1091,12 @@ void __cdecl s_test_handle(ctx_handle_t ctx_handle)
     ok(ctx_handle == (ctx_handle_t)0xdeadbeef, "Unexpected ctx_handle %p\n", ctx_handle);
 }
 
+int __cdecl s_explicit_handle_return(handle_t binding)
+{
+    ok(binding != NULL, "got NULL binding\n");
+    return INT_CODE;
+}
+
 void __RPC_USER ctx_handle_t_rundown(ctx_handle_t ctx_handle)
 {
     ok(ctx_handle == (ctx_handle_t)0xdeadbeef, "Unexpected ctx_handle %p\n", ctx_handle);
@@ -1149,6 +1157,8 @@ basic_tests(void)
   renum_t re;
 
   ok(int_return() == INT_CODE, "RPC int_return\n");
+  x = explicit_handle_return(is_interp ? IInterpServer_IfHandle : IMixedServer_IfHandle);
+  ok(x == INT_CODE, "RPC explicit_handle_return got %d\n", x);
 
   ok(square(7) == 49, "RPC square\n");
   x = sum(23, -4);
@@ -822,35 +822,47 @@ static int GSUB_is_glyph_covered(const void *table, unsigned int glyph)
 
     cf1 = table;
 
+    /* Glyphs and ranges are sorted by glyph index, so binary searches can be used. */
     if (GET_BE_WORD(cf1->CoverageFormat) == 1)
     {
         int count = GET_BE_WORD(cf1->GlyphCount);
-        int i;
+        int min = 0, max = count - 1;
         TRACE("Coverage Format 1, %i glyphs\n",count);
-        for (i = 0; i < count; i++)
-            if (glyph == GET_BE_WORD(cf1->GlyphArray[i]))
+        while (min <= max)
+        {
+            int i = (min + max) / 2;
+            unsigned int covered = GET_BE_WORD(cf1->GlyphArray[i]);
+
+            if (glyph == covered)
                 return i;
+            if (glyph < covered)
+                max = i - 1;
+            else
+                min = i + 1;
+        }
         return -1;
     }
     else if (GET_BE_WORD(cf1->CoverageFormat) == 2)
     {
         const OT_CoverageFormat2* cf2;
-        int i;
-        int count;
+        int count, min, max;
         cf2 = (const OT_CoverageFormat2*)cf1;
 
         count = GET_BE_WORD(cf2->RangeCount);
         TRACE("Coverage Format 2, %i ranges\n",count);
-        for (i = 0; i < count; i++)
+        min = 0;
+        max = count - 1;
+        while (min <= max)
         {
+            int i = (min + max) / 2;
+
             if (glyph < GET_BE_WORD(cf2->RangeRecord[i].Start))
-                return -1;
-            if ((glyph >= GET_BE_WORD(cf2->RangeRecord[i].Start)) &&
-                (glyph <= GET_BE_WORD(cf2->RangeRecord[i].End)))
-            {
+                max = i - 1;
+            else if (glyph > GET_BE_WORD(cf2->RangeRecord[i].End))
+                min = i + 1;
+            else
                 return (GET_BE_WORD(cf2->RangeRecord[i].StartCoverageIndex) +
                     glyph - GET_BE_WORD(cf2->RangeRecord[i].Start));
-            }
         }
         return -1;
     }
@@ -138,6 +138,57 @@ static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
 }
 
+/* Multiplies the color components of 32bpp pixels by their alpha value.
+ * (x + 1 + (x >> 8)) >> 8 is x / 255 for all x <= 255 * 255. */
+static void premultiply_alpha(BYTE *data, UINT stride, INT width, INT height)
+{
+    INT x, y;
+
+    for (y = 0; y < height; y++, data += stride)
+    {
+        BYTE *pixel = data;
+
+        for (x = 0; x < width; x++, pixel += 4)
+        {
+            UINT alpha = pixel[3], c;
+
+            if (alpha == 255) continue;
+
+            c = pixel[0] * alpha;
+            pixel[0] = (c + 1 + (c >> 8)) >> 8;
+            c = pixel[1] * alpha;
+            pixel[1] = (c + 1 + (c >> 8)) >> 8;
+            c = pixel[2] * alpha;
+            pixel[2] = (c + 1 + (c >> 8)) >> 8;
+        }
+    }
+}
+
+/* Divides the color components of 32bpp pixels by their alpha value.
+ * Multiplying by ceil((255 << 16) / alpha) and shifting gives the same result
+ * as c * 255 / alpha for all 8-bit c, with one division per pixel instead of three. */
+static void unpremultiply_alpha(BYTE *data, UINT stride, INT width, INT height)
+{
+    INT x, y;
+
+    for (y = 0; y < height; y++, data += stride)
+    {
+        BYTE *pixel = data;
+
+        for (x = 0; x < width; x++, pixel += 4)
+        {
+            UINT alpha = pixel[3], scale;
+
+            if (alpha == 0 || alpha == 255) continue;
+
+            scale = ((255 << 16) + alpha - 1) / alpha;
+            pixel[0] = (pixel[0] * scale) >> 16;
+            pixel[1] = (pixel[1] * scale) >> 16;
+            pixel[2] = (pixel[2] * scale) >> 16;
+        }
+    }
+}
+
 static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
@@ -730,22 +781,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+            unpremultiply_alpha(pbBuffer, cbStride, prc->Width, prc->Height);
         }
         return S_OK;
     case format_48bppRGB:
@@ -893,22 +933,10 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
     case format_32bppPRGBA:
         if (prc)
         {
-            INT x, y;
-
             hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(hr)) return hr;
 
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+            unpremultiply_alpha(pbBuffer, cbStride, prc->Width, prc->Height);
         }
         return S_OK;
 
@@ -966,21 +994,7 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_alpha(pbBuffer, cbStride, prc->Width, prc->Height);
         return hr;
     }
 }
@@ -999,21 +1013,7 @@ static HRESULT copypixels_to_32bppPRGBA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppRGBA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_alpha(pbBuffer, cbStride, prc->Width, prc->Height);
         return hr;
     }
 }
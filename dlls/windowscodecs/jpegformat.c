@@ -158,6 +158,8 @@ typedef struct {
     BYTE source_buffer[1024];
     UINT bpp, stride;
     BYTE *image_data;
+    LARGE_INTEGER stream_pos;
+    BOOL decode_failed;
     CRITICAL_SECTION lock;
 } JpegDecoder;
 
@@ -305,7 +307,7 @@ static HRESULT WINAPI JpegDecoder_Initialize(IWICBitmapDecoder *iface, IStream *
     int ret;
     LARGE_INTEGER seek;
     jmp_buf jmpbuf;
-    UINT data_size, i;
+    UINT data_size;
 
     TRACE("(%p,%p,%u)\n", iface, pIStream, cacheOptions);
 
@@ -399,40 +401,9 @@ static HRESULT WINAPI JpegDecoder_Initialize(IWICBitmapDecoder *iface, IStream *
         return E_OUTOFMEMORY;
     }
 
-    while (This->cinfo.output_scanline < This->cinfo.output_height)
-    {
-        UINT first_scanline = This->cinfo.output_scanline;
-        UINT max_rows;
-        JSAMPROW out_rows[4];
-        JDIMENSION ret;
-
-        max_rows = min(This->cinfo.output_height-first_scanline, 4);
-        for (i=0; i<max_rows; i++)
-            out_rows[i] = This->image_data + This->stride * (first_scanline+i);
-
-        ret = pjpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
-        if (ret == 0)
-        {
-            ERR("read_scanlines failed\n");
-            LeaveCriticalSection(&This->lock);
-            return E_FAIL;
-        }
-    }
-
-    if (This->bpp == 24)
-    {
-        /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
-        reverse_bgr8(3, This->image_data,
-            This->cinfo.output_width, This->cinfo.output_height,
-            This->stride);
-    }
-
-    if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
-    {
-        /* Adobe JPEG's have inverted CMYK data. */
-        for (i=0; i<data_size; i++)
-            This->image_data[i] ^= 0xff;
-    }
+    /* Scanlines are decoded on demand by CopyPixels(), remember where to resume reading. */
+    seek.QuadPart = 0;
+    IStream_Seek(This->stream, seek, STREAM_SEEK_CUR, (ULARGE_INTEGER *)&This->stream_pos);
 
     This->initialized = TRUE;
 
@@ -639,13 +610,84 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPalette(IWICBitmapFrameDecode *iface
     return E_NOTIMPL;
 }
 
+/* Decodes scanlines up to, but not including, last_scanline. Must be called with the lock held. */
+static HRESULT decode_scanlines(JpegDecoder *This, UINT last_scanline)
+{
+    jmp_buf jmpbuf;
+    UINT i;
+
+    if (This->decode_failed) return E_FAIL;
+    if (This->cinfo.output_scanline >= last_scanline) return S_OK;
+
+    This->cinfo.client_data = jmpbuf;
+
+    if (setjmp(jmpbuf))
+    {
+        This->decode_failed = TRUE;
+        return E_FAIL;
+    }
+
+    /* the stream might have been used by someone else since the last call */
+    IStream_Seek(This->stream, This->stream_pos, STREAM_SEEK_SET, NULL);
+
+    while (This->cinfo.output_scanline < last_scanline)
+    {
+        UINT first_scanline = This->cinfo.output_scanline;
+        UINT max_rows;
+        JSAMPROW out_rows[4];
+        JDIMENSION ret;
+
+        max_rows = min(This->cinfo.output_height-first_scanline, 4);
+        for (i=0; i<max_rows; i++)
+            out_rows[i] = This->image_data + This->stride * (first_scanline+i);
+
+        ret = pjpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
+        if (ret == 0)
+        {
+            ERR("read_scanlines failed\n");
+            This->decode_failed = TRUE;
+            return E_FAIL;
+        }
+
+        if (This->bpp == 24)
+        {
+            /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
+            reverse_bgr8(3, out_rows[0], This->cinfo.output_width, ret, This->stride);
+        }
+
+        if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
+        {
+            /* Adobe JPEG's have inverted CMYK data. */
+            for (i=0; i<This->stride * ret; i++)
+                out_rows[0][i] ^= 0xff;
+        }
+    }
+
+    /* source_mgr keeps the data that is already buffered, continue after it next time */
+    This->stream_pos.QuadPart = 0;
+    IStream_Seek(This->stream, This->stream_pos, STREAM_SEEK_CUR, (ULARGE_INTEGER *)&This->stream_pos);
+
+    return S_OK;
+}
+
 static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
+    UINT last_scanline = This->cinfo.output_height;
+    HRESULT hr;
 
     TRACE("(%p,%s,%u,%u,%p)\n", iface, debug_wic_rect(prc), cbStride, cbBufferSize, pbBuffer);
 
+    /* only decode as much of the image as is needed for the requested rectangle */
+    if (prc && prc->Y >= 0 && prc->Height >= 0 && prc->Y + prc->Height < last_scanline)
+        last_scanline = prc->Y + prc->Height;
+
+    EnterCriticalSection(&This->lock);
+    hr = decode_scanlines(This, last_scanline);
+    LeaveCriticalSection(&This->lock);
+    if (FAILED(hr)) return hr;
+
     return copy_pixels(This->bpp, This->image_data,
         This->cinfo.output_width, This->cinfo.output_height, This->stride,
         prc, cbStride, cbBufferSize, pbBuffer);
@@ -785,6 +827,7 @@ HRESULT JpegDecoder_CreateInstance(REFIID iid, void** ppv)
     This->cinfo_initialized = FALSE;
     This->stream = NULL;
     This->image_data = NULL;
+    This->decode_failed = FALSE;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": JpegDecoder.lock");
 
@@ -44,6 +44,32 @@ static const unsigned char utf8_mask[4] = { 0x7f, 0x1f, 0x0f, 0x07 };
 static const unsigned int utf8_minval[4] = { 0x0, 0x80, 0x800, 0x10000 };
 
 
+/* length of the 7-bit ASCII run at the start of a wide char string, four chars at a time */
+static inline unsigned int get_ascii_run_wcs( const WCHAR *src, unsigned int srclen )
+{
+    unsigned int pos, chars[2];
+
+    for (pos = 0; pos + 4 <= srclen; pos += 4)
+    {
+        memcpy( chars, src + pos, sizeof(chars) );
+        if ((chars[0] | chars[1]) & 0xff80ff80) break;
+    }
+    return pos;
+}
+
+/* length of the 7-bit ASCII run at the start of a UTF-8 string, four chars at a time */
+static inline unsigned int get_ascii_run_mbs( const char *src, unsigned int srclen )
+{
+    unsigned int pos, chars;
+
+    for (pos = 0; pos + 4 <= srclen; pos += 4)
+    {
+        memcpy( &chars, src + pos, sizeof(chars) );
+        if (chars & 0x80808080) break;
+    }
+    return pos;
+}
+
 /* get the next char value taking surrogates into account */
 static inline unsigned int get_surrogate_value( const WCHAR *src, unsigned int srclen )
 {
@@ -68,7 +94,10 @@ static inline int get_length_wcs_utf8( int flags, const WCHAR *src, unsigned int
     {
         if (*src < 0x80)  /* 0x00-0x7f: 1 byte */
         {
-            len++;
+            unsigned int run = get_ascii_run_wcs( src + 1, srclen - 1 );
+            len += run + 1;
+            src += run;
+            srclen -= run;
             continue;
         }
         if (*src < 0x800)  /* 0x80-0x7ff: 2 bytes */
@@ -108,8 +137,16 @@ int wine_utf8_wcstombs( int flags, const WCHAR *src, int srclen, char *dst, int
 
         if (ch < 0x80)  /* 0x00-0x7f: 1 byte */
         {
+            int i, run;
+
             if (!len--) return -1;  /* overflow */
             *dst++ = ch;
+            run = get_ascii_run_wcs( src + 1, srclen - 1 < len ? srclen - 1 : len );
+            for (i = 0; i < run; i++) dst[i] = src[i + 1];
+            dst += run;
+            src += run;
+            srclen -= run;
+            len -= run;
             continue;
         }
 
@@ -285,7 +322,9 @@ static inline int get_length_mbs_utf8( int flags, const char *src, int srclen )
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
-            ret++;
+            unsigned int run = get_ascii_run_mbs( src, srcend - src );
+            ret += run + 1;
+            src += run;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0x10ffff)
@@ -316,7 +355,13 @@ int wine_utf8_mbstowcs( int flags, const char *src, int srclen, WCHAR *dst, int
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
+            unsigned int i, run;
+
             *dst++ = ch;
+            run = get_ascii_run_mbs( src, srcend - src < dstend - dst ? srcend - src : dstend - dst );
+            for (i = 0; i < run; i++) dst[i] = src[i];
+            dst += run;
+            src += run;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)